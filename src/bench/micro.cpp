@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../io/bench.hpp"
+#include "../mcts/mcts.hpp"
+
+namespace {
+    constexpr auto Repetitions = 7;
+    constexpr auto TargetNs = std::int64_t{20000000};
+
+    // ops return a value derived from their work, summed and stored here
+    // once per timing so that the work is not optimised away
+    volatile std::uint64_t sink = 0;
+
+    template <typename Op>
+    double timeOps(Op& op, std::int64_t iters)
+    {
+        std::uint64_t total = 0;
+        const auto clockStart = std::chrono::steady_clock::now();
+        for (std::int64_t i = 0; i < iters; i++)
+            total += op();
+        const auto dur = std::chrono::steady_clock::now() - clockStart;
+        sink = total;
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count();
+        return static_cast<double>(ns) / static_cast<double>(iters);
+    }
+
+    // Warms up while calibrating the iteration count to roughly `TargetNs`
+    // per repetition, then returns the median ns/op of the repetitions.
+    template <typename Op>
+    double measure(Op op)
+    {
+        std::int64_t iters = 1;
+        while (timeOps(op, iters) * iters < TargetNs / 4 && iters < (1 << 24))
+            iters *= 2;
+
+        iters *= 4;
+
+        std::vector<double> samples{};
+        for (auto rep = 0; rep < Repetitions; rep++)
+            samples.push_back(timeOps(op, iters));
+
+        std::sort(samples.begin(), samples.end());
+        return samples[Repetitions / 2];
+    }
+
+    void emit(std::size_t position, std::uint16_t size, const char* name, double ns)
+    {
+        std::cout << position << "," << size << "," << name << "," << ns << std::endl;
+    }
+}
+
+class MicroBench
+{
+    public:
+        static void run()
+        {
+            std::cout << "position,size,primitive,ns_per_op" << std::endl;
+
+            const auto& positions = benchPositions();
+            for (std::size_t i = 0; i < positions.size(); i++)
+                runPosition(i + 1, positions[i]);
+        }
+
+    private:
+        static void runPosition(std::size_t idx, const BenchPosition& position)
+        {
+            const auto size = position.size;
+            auto board = setupPosition(position);
+            const auto state = board.board;
+
+            const auto copyNs = measure([&] {
+                auto copy = state;
+                return std::uint64_t{copy.numStones()[0]};
+            });
+
+            emit(idx, size, "copy", copyNs);
+
+            std::vector<Tile> empties{};
+            const auto head = state.moveHead();
+            for (auto tile = head.first; !tile.isNull(); tile = state[tile].next)
+                empties.push_back(tile);
+
+            // Copying the state is part of every timed op below, so the
+            // placements are batched to amortise it away.
+            std::vector<Tile> targets{};
+            const auto stride = std::max<std::size_t>(1, empties.size() / 16);
+            for (std::size_t i = 0; i < empties.size(); i += stride)
+                targets.push_back(empties[i]);
+
+            const auto placeNs = measure([&] {
+                auto copy = state;
+                auto colour = board.sideToMove();
+                std::uint64_t suicides = 0;
+                for (const auto tile : targets)
+                {
+                    suicides += copy.placeStone(tile, colour);
+                    colour = flipColour(colour);
+                }
+                return suicides;
+            });
+
+            const auto placeStoneNs = (placeNs - copyNs) / targets.size();
+            emit(idx, size, "placeStone", placeStoneNs);
+
+            // Groups are only killed once captured. Positions rarely hold
+            // a group in atari, so all but one liberty of each group is
+            // filled in first, and every capture is then set up by playing
+            // the last one on a fresh copy. The copies and an ordinary
+            // placement are taken off again.
+            struct Capture
+            {
+                BoardState base;
+                Tile tile;
+                Colour colour;
+            };
+
+            std::vector<Capture> captures{};
+            std::vector<std::uint16_t> groupIds{};
+            for (auto i = 0; i < state.sizeOf() && captures.size() < 16; i++)
+            {
+                const auto stone = Tile(static_cast<std::uint16_t>(i));
+                const auto owner = state.belongsTo(stone);
+                const auto groupId = state[stone].group;
+                if (owner == Colour::None || std::find(groupIds.begin(), groupIds.end(), groupId) != groupIds.end())
+                    continue;
+
+                groupIds.push_back(groupId);
+
+                std::vector<Tile> libs{};
+                for (auto tile = state.stonesOf(stone).first; !tile.isNull(); tile = state[tile].next)
+                {
+                    const auto dirs = Vec4::getAdjacent(tile, size);
+                    for (auto d = 0; d < dirs.length; d++)
+                    {
+                        const auto adjTile = dirs.elements[d];
+                        if (state.belongsTo(adjTile) == Colour::None && std::find(libs.begin(), libs.end(), adjTile) == libs.end())
+                            libs.push_back(adjTile);
+                    }
+                }
+
+                // filling in must neither capture nor be suicide
+                const auto chaser = flipColour(owner);
+                auto base = state;
+                auto filled = !libs.empty();
+                for (std::size_t k = 0; filled && k + 1 < libs.size(); k++)
+                {
+                    const auto before = base.numStones();
+                    filled = !base.placeStone(libs[k], chaser) && base.numStones()[static_cast<std::size_t>(owner)] == before[static_cast<std::size_t>(owner)];
+                }
+
+                auto check = base;
+                if (filled && !check.placeStone(libs.back(), chaser) && check.belongsTo(stone) == Colour::None)
+                    captures.push_back(Capture{base, libs.back(), chaser});
+            }
+
+            if (!captures.empty())
+            {
+                const auto baseNs = measure([&] {
+                    std::uint64_t stones = 0;
+                    for (const auto& capture : captures)
+                    {
+                        auto copy = capture.base;
+                        stones += copy.numStones()[0];
+                    }
+                    return stones;
+                });
+
+                const auto captureNs = measure([&] {
+                    std::uint64_t stones = 0;
+                    for (const auto& capture : captures)
+                    {
+                        auto copy = capture.base;
+                        copy.placeStone(capture.tile, capture.colour);
+                        stones += copy.numStones()[0];
+                    }
+                    return stones;
+                });
+
+                emit(idx, size, "killGroup", (captureNs - baseNs) / captures.size() - placeStoneNs);
+            }
+
+            emit(idx, size, "getTerritory", measure([&] {
+                return static_cast<std::uint64_t>(state.getTerritory().size());
+            }));
+
+            emit(idx, size, "getScore", measure([&] {
+                return static_cast<std::uint64_t>(state.getScore(position.komi));
+            }));
+
+            Mcts searcher{};
+            searcher.logging = false;
+            searcher.board = board;
+            searcher.startSearch();
+
+            std::vector<Tile> moves{};
+            emit(idx, size, "genViable", measure([&] {
+                moves.clear();
+                searcher.genViable(moves);
+                return static_cast<std::uint64_t>(moves.size());
+            }));
+
+            emit(idx, size, "playout", measure([&] {
+                return static_cast<std::uint64_t>(searcher.simulate());
+            }));
+
+            emit(idx, size, "SearchTree", measure([&] {
+                const auto tree = SearchTree(searcher.board);
+                return std::uint64_t{tree[0].numChildren()};
+            }));
+        }
+};
+
+int main()
+{
+    MicroBench::run();
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include <chrono>
+
+#include "../mcts/mcts.hpp"
+#include "bench.hpp"
+#include "parse.hpp"
+
+namespace {
+    constexpr auto BenchSeed = UINT64_C(2078630127);
+}
+
+const std::vector<BenchPosition>& benchPositions()
+{
+    static const std::vector<BenchPosition> positions = {
+        {9, 7.5, 256, ""},
+        {9, 7.5, 256, "e5 c4 g5 f3 d6 c6 c7 b7 f7 g3 d3 d4"},
+        {13, 7.5, 64, "d4 k10 k4 d10 c6 g3 j11 k11 j10 f10"},
+        {13, 7.5, 64, "g7 f6 f7 e7 e8 d8 e6 f5 d7 e9 f8 c7"},
+        {19, 7.5, 16, "q16 d4 q3 d16 r5 f17 c14 k16 o17 c6"},
+        {19, 7.5, 16, "d16 q4 p16 d4 c6 f3 r6 q6 r7 q7 r8 n3 q10"},
+    };
+
+    return positions;
+}
+
+Board setupPosition(const BenchPosition& position)
+{
+    auto board = Board(position.size);
+    board.setKomi(position.komi);
+
+    auto colour = std::string("b");
+    for (auto rest = position.moves; !rest.empty();)
+    {
+        auto [tileStr, remaining] = splitAt(rest, ' ');
+        rest = remaining;
+
+        auto moveStr = colour + " " + tileStr;
+        const auto [tile, side] = parseMove(moveStr, position.size);
+
+        board.setStm(side);
+        if (!board.tryMakeMove(tile))
+            throw std::invalid_argument("illegal bench move " + moveStr);
+
+        colour = colour == "b" ? "w" : "b";
+    }
+
+    return board;
+}
+
+BenchResult runBench()
+{
+    BenchResult result{};
+
+    auto idx = 0;
+    for (const auto& position : benchPositions())
+    {
+        Mcts searcher{};
+        searcher.logging = false;
+        searcher.board = setupPosition(position);
+        searcher.timer = Timer::unlimited();
+        searcher.setNodes(position.rollouts);
+        searcher.setSeed(BenchSeed);
+
+        const auto clockStart = std::chrono::steady_clock::now();
+        const auto move = searcher.search();
+        const auto dur = std::chrono::steady_clock::now() - clockStart;
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(dur).count();
+
+        idx++;
+        result.nodes += searcher.board.nodes;
+        result.time += ms;
+        result.report += "position " + std::to_string(idx);
+        result.report += " size " + std::to_string(position.size);
+        result.report += " nodes " + std::to_string(searcher.board.nodes);
+        result.report += " bestmove " + tileToString(move, position.size) + "\n";
+    }
+
+    const auto nps = result.time > 0 ? 1000 * result.nodes / result.time : result.nodes;
+
+    result.report += "nodes " + std::to_string(result.nodes);
+    result.report += " time " + std::to_string(result.time);
+    result.report += " nps " + std::to_string(nps);
+
+    return result;
+}
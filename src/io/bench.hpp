@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../state/board.hpp"
+
+struct BenchPosition
+{
+    std::uint16_t size;
+    float komi;
+    std::int32_t rollouts;
+    std::string moves;
+};
+
+struct BenchResult
+{
+    std::uint64_t nodes{};
+    std::int64_t time{};
+    std::string report{};
+};
+
+const std::vector<BenchPosition>& benchPositions();
+
+Board setupPosition(const BenchPosition& position);
+
+BenchResult runBench();
@@ -1,5 +1,11 @@
+#include "../mcts/network.hpp"
+#include "../mcts/solver.hpp"
+#include "../mcts/trace.hpp"
+#include "bench.hpp"
+#include "mapped.hpp"
 #include "gtp.hpp"
 #include "parse.hpp"
+#include "sgf.hpp"
 
 GtpRunner::GtpRunner()
 {
@@ -20,43 +26,74 @@ GtpRunner::GtpRunner()
     commands.insert({"get_komi", &GtpRunner::getKomi});
     commands.insert({"time_settings", &GtpRunner::timeSettings});
     commands.insert({"logging", &GtpRunner::logging});
+    commands.insert({"stats", &GtpRunner::searchStats});
+    commands.insert({"bench", &GtpRunner::bench});
+    commands.insert({"loadnet", &GtpRunner::loadNet});
+    commands.insert({"netweight", &GtpRunner::netWeight});
+    commands.insert({"solve", &GtpRunner::solve});
+    commands.insert({"loadbook", &GtpRunner::loadBook});
+    commands.insert({"savetree", &GtpRunner::saveTree});
+    commands.insert({"loadtree", &GtpRunner::loadTree});
+    commands.insert({"analyze", &GtpRunner::analyze});
+    commands.insert({"loadsgf", &GtpRunner::loadSgf});
+    commands.insert({"final_score", &GtpRunner::finalScore});
+    commands.insert({"final_status_list", &GtpRunner::finalStatusList});
+    commands.insert({"batchplayouts", &GtpRunner::batchPlayouts});
+    commands.insert({"leafthreads", &GtpRunner::leafThreads});
+    commands.insert({"deterministic", &GtpRunner::deterministic});
+    commands.insert({"savetrace", &GtpRunner::saveTrace});
+    commands.insert({"time_left", &GtpRunner::timeLeftCmd});
+    commands.insert({"moveoverhead", &GtpRunner::setMoveOverhead});
 }
 
 void GtpRunner::run()
 {
     for (std::string line{}; std::getline(std::cin, line);)
-	{
-        auto tokens = splitAt(line, ' ');
+        execute(line);
 
-        try { currId = std::stoi(tokens.first); }
-        catch(...) { currId = -1; }
+    stopAnalysis();
+}
 
-        if (currId != -1)
-            tokens = splitAt(tokens.second, ' ');
+void GtpRunner::execute(const std::string& line)
+{
+    received = std::chrono::steady_clock::now();
 
-        const auto command = tokens.first;
+    // any command ends a running analysis
+    stopAnalysis();
 
-        if (commands.find(command) == commands.end())
-        {
-            reportFailure("unknown command");
-            continue;
-        }
+    auto tokens = splitAt(line, ' ');
 
-        storedMessage = tokens.second;
+    try { currId = std::stoi(tokens.first); }
+    catch(...) { currId = -1; }
 
-        auto func = commands[command];
+    if (currId != -1)
+        tokens = splitAt(tokens.second, ' ');
+
+    const auto command = tokens.first;
 
-        try { func(*this); }
-        catch(...) { reportFailure("unknown command"); }
+    if (commands.find(command) == commands.end())
+    {
+        reportFailure("unknown command");
+        return;
     }
+
+    storedMessage = tokens.second;
+
+    const auto entry = commands.find(command);
+    // the command table dies with this runner, but trace records do not
+    const auto trace = TraceScope(TrackTrace ? traceName(entry->first) : "");
+    auto func = entry->second;
+
+    try { func(*this); }
+    catch(...) { reportFailure("unknown command"); }
 }
 
 void GtpRunner::report(char status, std::string message) const
 {
-    std::cout << status;
+    *out << status;
     if (currId != -1)
-        std::cout << currId;
-    std::cout << " " << message << "\n" << std::endl;
+        *out << currId;
+    *out << " " << message << "\n" << std::endl;
 }
 
 void GtpRunner::listCommands() const
@@ -89,6 +126,7 @@ void GtpRunner::boardSize()
     searcher.board = Board(size);
     searcher.board.setKomi(komi);
     searcher.timer.reset();
+    timeLeft = {};
     reportSuccess("");
 }
 
@@ -98,6 +136,7 @@ void GtpRunner::clearBoard()
     searcher.board = Board(size);
     searcher.board.setKomi(komi);
     searcher.timer.reset();
+    timeLeft = {};
     reportSuccess("");
 };
 
@@ -109,7 +148,7 @@ void GtpRunner::komi()
 
 void GtpRunner::showBoard() const
 {
-    searcher.board.display(false);
+    searcher.board.display(false, *out);
 }
 
 void GtpRunner::play()
@@ -140,12 +179,24 @@ void GtpRunner::genMove()
 
     searcher.board.setStm(colour);
 
+    auto& clock = timeLeft[static_cast<std::size_t>(colour)];
+    if (clock)
+    {
+        searcher.timer.sync(clock->first, clock->second);
+        clock.reset();
+    }
+
     const auto move = searcher.search();
 
     searcher.board.makeMove(move);
 
     const auto moveStr = tileToString(move, searcher.board.size());
     reportSuccess(moveStr);
+
+    // everything but the search itself, now that the reply is flushed
+    const auto dur = std::chrono::steady_clock::now() - received;
+    const auto total = std::chrono::duration_cast<std::chrono::milliseconds>(dur).count();
+    searcher.timer.addLag(std::max<std::int64_t>(total - searcher.timer.lastMoveTime(), 0));
 }
 
 void GtpRunner::stones()
@@ -178,6 +229,8 @@ void GtpRunner::timeSettings()
     const auto byoYomi = std::stoi(byoYomiStr);
     const auto byoYomiStones = std::stoi(byoYomiStonesStr);
     searcher.timer = Timer(mainTime, byoYomi, byoYomiStones);
+    searcher.timer.setOverhead(moveOverhead);
+    timeLeft = {};
 
     reportSuccess("");
 }
@@ -186,4 +239,330 @@ void GtpRunner::logging()
 {
     searcher.logging = !searcher.logging;
     reportSuccess("");
+}
+
+void GtpRunner::searchStats() const
+{
+    reportSuccess(searcher.lastStats().report());
+}
+
+void GtpRunner::bench() const
+{
+    reportSuccess(runBench().report);
+}
+
+void GtpRunner::loadNet()
+{
+    std::shared_ptr<Evaluator> network;
+    try { network = std::make_shared<ValueNetwork>(storedMessage); }
+    catch(const std::exception& err)
+    {
+        reportFailure(err.what());
+        return;
+    }
+
+    searcher.setEvaluator(network, 1.0F);
+    reportSuccess("");
+}
+
+void GtpRunner::netWeight()
+{
+    const auto weight = std::stof(storedMessage);
+    if (weight < 0.0F || weight > 1.0F)
+        return reportFailure("weight must be between 0 and 1");
+
+    searcher.setEvalWeight(weight);
+    reportSuccess("");
+}
+
+void GtpRunner::batchPlayouts()
+{
+    if (storedMessage != "on" && storedMessage != "off")
+        return reportFailure("expected on or off");
+
+    searcher.setBatchPlayouts(storedMessage == "on");
+    reportSuccess("");
+}
+
+void GtpRunner::leafThreads()
+{
+    const auto threads = std::stoi(storedMessage);
+    if (threads < 1 || threads > 256)
+        return reportFailure("threads must be between 1 and 256");
+
+    // a shared pool is left as it is, its size caps the rollouts in flight
+    const auto count = static_cast<std::size_t>(threads);
+    if (count > 1 && !sharedLeafPool && (!leafPool || leafPool->size() != count))
+        leafPool = std::make_shared<ThreadPool>(count);
+
+    searcher.setLeafThreads(count, leafPool);
+    reportSuccess("");
+}
+
+void GtpRunner::deterministic()
+{
+    if (storedMessage == "off")
+    {
+        searcher.setDeterministic(false);
+        searcher.setNodes(Mcts::DefaultNodes);
+        return reportSuccess("");
+    }
+
+    // the clock is ignored, so a node budget is needed to stop at all
+    const auto nodes = std::stoi(storedMessage);
+    if (nodes < 1)
+        return reportFailure("expected a node budget or off");
+
+    searcher.setDeterministic(true);
+    searcher.setNodes(nodes);
+    reportSuccess("");
+}
+
+void GtpRunner::solve()
+{
+    const auto maxDepth = storedMessage.empty() ? 64 : std::stoi(storedMessage);
+
+    Solver solver{};
+    const auto result = solver.solve(searcher.board, maxDepth);
+
+    const auto outcome = result.result == State::Win ? "win"
+                       : result.result == State::Loss ? "loss"
+                       : "unknown";
+
+    auto message = std::string(outcome);
+    message += " " + tileToString(result.move, searcher.board.size());
+    message += " depth " + std::to_string(result.depth);
+    message += " nodes " + std::to_string(result.nodes);
+
+    reportSuccess(message);
+}
+
+void GtpRunner::loadBook()
+{
+    const auto [path, pliesStr] = splitAt(storedMessage, ' ');
+    const auto plies = pliesStr.empty() ? DefaultBookPlies : std::stoul(pliesStr);
+
+    std::shared_ptr<const OpeningBook> book;
+    try { book = std::make_shared<const OpeningBook>(path); }
+    catch(const std::exception& err)
+    {
+        reportFailure(err.what());
+        return;
+    }
+
+    searcher.setBook(book, plies);
+    reportSuccess("entries " + std::to_string(book->size()));
+}
+
+void GtpRunner::saveTree()
+{
+    try { searcher.saveTree(storedMessage); }
+    catch(const std::exception& err)
+    {
+        reportFailure(err.what());
+        return;
+    }
+
+    reportSuccess("");
+}
+
+void GtpRunner::loadTree()
+{
+    auto matches = false;
+    try { matches = searcher.loadTree(storedMessage); }
+    catch(const std::exception& err)
+    {
+        reportFailure(err.what());
+        return;
+    }
+
+    if (matches)
+        reportSuccess("");
+    else
+        reportFailure("tree is for a different position");
+}
+
+void GtpRunner::analyze()
+{
+    // analyze [colour] <interval in centiseconds>
+    auto [first, rest] = splitAt(storedMessage, ' ');
+    if (!rest.empty())
+    {
+        searcher.board.setStm(parseColour(first));
+        first = rest;
+    }
+
+    const auto interval = 10 * static_cast<std::int64_t>(std::stoi(first));
+
+    // The response is streamed by the search thread, and ended by the
+    // blank line written in `stopAnalysis`.
+    auto header = std::string("=");
+    if (currId != -1)
+        header += std::to_string(currId);
+    writeAnalysis(header + "\n");
+
+    analysis = std::thread([this, interval] {
+        searcher.analyse(interval, [this](const std::string& info) { writeAnalysis(info); });
+    });
+}
+
+void GtpRunner::stopAnalysis()
+{
+    if (!analysis.joinable())
+        return;
+
+    searcher.stop();
+    analysis.join();
+    writeAnalysis("\n");
+}
+
+void GtpRunner::writeAnalysis(const std::string& text)
+{
+    if (analysisSink)
+        analysisSink(text);
+    else
+        *out << text << std::flush;
+}
+
+void GtpRunner::loadSgf()
+{
+    // loadsgf <file> [move], setting up the position before `move`
+    const auto [path, moveStr] = splitAt(storedMessage, ' ');
+
+    try
+    {
+        const MappedFile file(path);
+        const auto text = std::string_view(file.data(), file.size());
+
+        SgfGame game{};
+        std::size_t pos = 0;
+        if (!parseSgf(text, pos, game) || game.size > 25)
+            return reportFailure("cannot load file");
+
+        // moves are numbered from 1
+        const auto moveNum = moveStr.empty() ? 0 : std::stol(moveStr);
+        if (!moveStr.empty() && moveNum < 1)
+            return reportFailure("move number must be at least 1");
+
+        const auto numMoves = moveStr.empty() ? game.moves.size() : static_cast<std::size_t>(moveNum - 1);
+
+        searcher.board = replaySgf(game, numMoves);
+        size = game.size;
+    }
+    catch(const std::invalid_argument& err)
+    {
+        reportFailure(err.what());
+        return;
+    }
+    catch(...)
+    {
+        reportFailure("cannot load file");
+        return;
+    }
+
+    searcher.timer.reset();
+    reportSuccess("");
+}
+
+std::vector<float> GtpRunner::scoringOwnership()
+{
+    searcher.sampleOwnership(ScoringRollouts, ScoringTime);
+    auto ownership = searcher.ownership();
+
+    // a finished game has no rollouts, so score the board as it stands
+    if (searcher.board.board.isGameOver())
+    {
+        std::vector<std::int32_t> owned(ownership.size(), 0);
+        searcher.board.board.getScore(searcher.board.getKomi(), &owned);
+        for (std::size_t i = 0; i < owned.size(); i++)
+            ownership[i] = static_cast<float>(owned[i]);
+    }
+    // with netweight 1 no rollouts run, and there is nothing to go on
+    else if (searcher.ownershipSamples() == 0)
+        return {};
+
+    return ownership;
+}
+
+void GtpRunner::finalScore()
+{
+    const auto ownership = scoringOwnership();
+    if (ownership.empty())
+        return reportFailure("cannot score without rollouts");
+
+    // each point goes to whoever owns it in most rollouts
+    auto score = -searcher.board.getKomi();
+    for (const auto share : ownership)
+        score += static_cast<float>(share > 0.0F) - static_cast<float>(share < 0.0F);
+
+    if (score == 0.0F)
+        return reportSuccess("0");
+
+    std::ostringstream message{};
+    message << (score > 0.0F ? "B+" : "W+") << std::abs(score);
+    reportSuccess(message.str());
+}
+
+void GtpRunner::finalStatusList()
+{
+    if (storedMessage != "alive" && storedMessage != "dead" && storedMessage != "seki")
+        return reportFailure("syntax error");
+
+    const auto ownership = scoringOwnership();
+    if (ownership.empty())
+        return reportFailure("cannot score without rollouts");
+    const auto& state = searcher.board.board;
+
+    std::string list{};
+    for (std::size_t i = 0; i < ownership.size(); i++)
+    {
+        const auto tile = Tile(static_cast<std::uint16_t>(i));
+        const auto colour = state.belongsTo(tile);
+        if (colour == Colour::None)
+            continue;
+
+        // stones mostly owned by the opponent by the end of rollouts are dead
+        const auto share = colour == Colour::Black ? ownership[i] : -ownership[i];
+        const auto dead = share < 0.0F;
+
+        // seki is not told apart from life
+        if ((storedMessage == "dead") == dead && storedMessage != "seki")
+            list += (list.empty() ? "" : " ") + tileToString(tile, size);
+    }
+
+    reportSuccess(list);
+}
+
+void GtpRunner::saveTrace()
+{
+    if constexpr (!TrackTrace)
+        return reportFailure("tracing needs a `make trace` build");
+
+    try { reportSuccess(std::to_string(::saveTrace(storedMessage)) + " events"); }
+    catch(...) { reportFailure("cannot write file"); }
+}
+
+void GtpRunner::timeLeftCmd()
+{
+    // time_left <colour> <seconds> <stones>
+    auto [colourStr, rem] = splitAt(storedMessage, ' ');
+    const auto [timeStr, stonesStr] = splitAt(rem, ' ');
+
+    const auto colour = parseColour(colourStr);
+    const auto ms = static_cast<std::int64_t>(1000.0 * std::stod(timeStr));
+    const auto stones = std::stoll(stonesStr);
+
+    timeLeft[static_cast<std::size_t>(colour)] = std::pair{ms, stones};
+    reportSuccess("");
+}
+
+void GtpRunner::setMoveOverhead()
+{
+    const auto ms = std::stoll(storedMessage);
+    if (ms < 0)
+        return reportFailure("overhead must not be negative");
+
+    moveOverhead = ms;
+    searcher.timer.setOverhead(ms);
+    reportSuccess("");
 }
\ No newline at end of file
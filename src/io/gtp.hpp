@@ -1,8 +1,12 @@
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <functional>
+#include <optional>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "../mcts/mcts.hpp"
@@ -13,14 +17,56 @@ class GtpRunner
     public:
         GtpRunner();
 
+        ~GtpRunner() { stopAnalysis(); }
+
         void run();
 
+        // Runs a single command, writing the response to `output`.
+        void execute(const std::string& line);
+
+        void setOutput(std::ostream& output) { out = &output; }
+
+        // Analysis is written from the search thread as it goes, through
+        // `sink` if one is given, or else straight to the output.
+        void setAnalysisOutput(std::function<void(const std::string&)> sink) { analysisSink = std::move(sink); }
+
+        // leaf rollouts run on `pool`, shared with other runners, instead
+        // of on a pool of this runner's own
+        void setLeafPool(std::shared_ptr<ThreadPool> pool) { leafPool = std::move(pool); sharedLeafPool = true; }
+
+        // ends a running analysis along with its response
+        void stopAnalysis();
+
+        void setLogging(bool enabled) { searcher.logging = enabled; }
+
+        void setBook(std::shared_ptr<const OpeningBook> book, std::size_t plies)
+        {
+            searcher.setBook(std::move(book), plies);
+        }
+
+        static constexpr std::size_t DefaultBookPlies = 20;
+
+        // rollout and time budget for scoring a position
+        static constexpr std::int32_t ScoringRollouts = 1000;
+        static constexpr std::int64_t ScoringTime = 2000;
+
     private:
         Mcts searcher{};
         std::uint16_t size = 3;
         std::string storedMessage = "";
         std::unordered_map<std::string, std::function<void(GtpRunner&)>> commands{};
         int currId = -1;
+        std::thread analysis{};
+        std::ostream* out = &std::cout;
+        std::function<void(const std::string&)> analysisSink{};
+        std::shared_ptr<ThreadPool> leafPool{};
+        bool sharedLeafPool = false;
+
+        // when the command being run arrived, to measure reply latency
+        std::chrono::steady_clock::time_point received{};
+        std::int64_t moveOverhead = 0;
+        // time and stones from time_left for each colour, used at its next genmove
+        std::array<std::optional<std::pair<std::int64_t, std::int64_t>>, 2> timeLeft{};
 
         void report(char status, std::string message) const;
 
@@ -61,4 +107,44 @@ class GtpRunner
         void timeSettings();
 
         void logging();
+
+        void searchStats() const;
+
+        void bench() const;
+
+        void loadNet();
+
+        void netWeight();
+
+        void solve();
+
+        void loadBook();
+
+        void saveTree();
+
+        void loadTree();
+
+        void analyze();
+
+        void writeAnalysis(const std::string& text);
+
+        void loadSgf();
+
+        void batchPlayouts();
+
+        void leafThreads();
+
+        void deterministic();
+
+        void saveTrace();
+
+        void timeLeftCmd();
+
+        void setMoveOverhead();
+
+        std::vector<float> scoringOwnership();
+
+        void finalScore();
+
+        void finalStatusList();
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include <fstream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped.hpp"
+
+MappedFile::MappedFile(const std::string& path)
+{
+#if !defined(_WIN32)
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+
+    length = static_cast<std::size_t>(info.st_size);
+
+    if (length > 0)
+    {
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("cannot map " + path);
+        }
+
+        ptr = static_cast<const char*>(mapped);
+    }
+
+    close(fd);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw std::runtime_error("cannot open " + path);
+
+    length = static_cast<std::size_t>(file.tellg());
+    buffer.resize(length);
+    file.seekg(0);
+    file.read(buffer.data(), static_cast<std::streamsize>(length));
+    ptr = buffer.data();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if !defined(_WIN32)
+    if (ptr != nullptr)
+        munmap(const_cast<char*>(ptr), length);
+#endif
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Mapped into memory where the platform
+// allows it, so opening is instant and the pages are shared between
+// processes, otherwise the file is read into a buffer.
+class MappedFile
+{
+    public:
+        explicit MappedFile(const std::string& path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        [[nodiscard]] const char* data() const { return ptr; }
+        [[nodiscard]] std::size_t size() const { return length; }
+
+    private:
+        const char* ptr = nullptr;
+        std::size_t length = 0;
+        std::vector<char> buffer{};
+};
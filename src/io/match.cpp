@@ -0,0 +1,313 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../state/board.hpp"
+#include "match.hpp"
+#include "parse.hpp"
+#include "process.hpp"
+
+namespace {
+    struct SideStats
+    {
+        std::uint64_t moves = 0;
+        std::int64_t time = 0;
+        std::uint64_t nodes = 0;
+        std::int64_t searchTime = 0;
+    };
+
+    struct Tally
+    {
+        std::uint32_t wins = 0;
+        std::uint32_t draws = 0;
+        std::uint32_t losses = 0;
+        std::array<SideStats, 2> sides{};
+
+        [[nodiscard]] auto games() const { return wins + draws + losses; }
+        [[nodiscard]] double score() const { return (wins + 0.5 * draws) / games(); }
+
+        // per game variance of the score
+        [[nodiscard]] double variance() const
+        {
+            const auto s = score();
+            const auto sum = wins * (1.0 - s) * (1.0 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s;
+            return sum / games();
+        }
+    };
+
+    double expectedScore(double elo)
+    {
+        return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+    }
+
+    double eloOf(double score)
+    {
+        return -400.0 * std::log10(1.0 / score - 1.0);
+    }
+
+    // log likelihood ratio of H1 over H0, with the score normally approximated
+    double logLikelihoodRatio(const Tally& tally, const MatchOptions& options)
+    {
+        const auto var = tally.variance();
+        if (var <= 0.0)
+            return 0.0;
+
+        const auto s0 = expectedScore(options.elo0);
+        const auto s1 = expectedScore(options.elo1);
+
+        return tally.games() * (s1 - s0) * (2.0 * tally.score() - s0 - s1) / (2.0 * var);
+    }
+
+    std::vector<std::string> loadOpenings(const MatchOptions& options)
+    {
+        if (options.openings.empty())
+        {
+            if (options.size < 9)
+                return {""};
+
+            return {"", "e5", "c3", "e5 c4", "e5 e3", "c3 g7", "e5 d3 g4", "c4 f5 e3"};
+        }
+
+        std::ifstream in(options.openings);
+        if (!in)
+            throw std::runtime_error("cannot read " + options.openings);
+
+        std::vector<std::string> openings{};
+        for (std::string line{}; std::getline(in, line);)
+            if (!line.empty() && line[0] != '#')
+                openings.push_back(line);
+
+        if (openings.empty())
+            openings.push_back("");
+
+        return openings;
+    }
+
+    std::string colourName(Colour colour)
+    {
+        return colour == Colour::Black ? "b" : "w";
+    }
+
+    // reads the node count and search time from Gotcha's final info line
+    void countNodes(const std::vector<std::string>& info, SideStats& side)
+    {
+        for (const auto& line : info)
+        {
+            const auto timePos = line.find("# info time ");
+            const auto nodesPos = line.find(" nodes ");
+            if (timePos != 0 || nodesPos == std::string::npos)
+                continue;
+
+            side.searchTime += std::stoll(line.substr(12));
+            side.nodes += std::stoull(line.substr(nodesPos + 7));
+        }
+    }
+
+    // Plays one game, returning the score of the first engine.
+    double playGame(const MatchOptions& options, std::array<std::unique_ptr<EngineProcess>, 2>& engines,
+                    bool firstIsBlack, const std::string& opening, std::array<SideStats, 2>& sides)
+    {
+        auto board = Board(options.size);
+        board.setKomi(options.komi);
+
+        for (auto& engine : engines)
+        {
+            engine->send("boardsize " + std::to_string(options.size));
+            engine->send("clear_board");
+            engine->send("komi " + std::to_string(options.komi));
+            engine->send("time_settings 0 " + std::to_string(options.secondsPerMove) + " 1");
+        }
+
+        for (auto rest = opening; !rest.empty();)
+        {
+            auto [tileStr, remaining] = splitAt(rest, ' ');
+            rest = remaining;
+            if (tileStr.empty())
+                continue;
+
+            auto moveStr = colourName(board.sideToMove()) + " " + tileStr;
+            const auto [tile, colour] = parseMove(moveStr, options.size);
+            if (!board.tryMakeMove(tile))
+                throw std::invalid_argument("illegal opening move " + tileStr);
+
+            for (auto& engine : engines)
+                engine->send("play " + moveStr);
+        }
+
+        const auto maxMoves = static_cast<std::size_t>(3 * board.board.sizeOf());
+
+        while (!board.board.isGameOver() && board.plies() < maxMoves)
+        {
+            const auto colour = board.sideToMove();
+            const auto mover = (colour == Colour::Black) == firstIsBlack ? 0 : 1;
+            // score of the first engine when the mover forfeits
+            const auto forfeit = mover == 0 ? 0.0 : 1.0;
+
+            std::vector<std::string> info{};
+            const auto clockStart = std::chrono::steady_clock::now();
+            auto reply = engines[mover]->send("genmove " + colourName(colour), &info);
+            const auto dur = std::chrono::steady_clock::now() - clockStart;
+
+            auto& side = sides[mover];
+            side.moves++;
+            side.time += std::chrono::duration_cast<std::chrono::milliseconds>(dur).count();
+            countNodes(info, side);
+
+            makeLower(reply);
+            if (reply == "resign")
+                return forfeit;
+
+            // an illegal or unreadable move loses the game
+            const auto moveStr = colourName(colour) + " " + reply;
+
+            try
+            {
+                auto moveCopy = moveStr;
+                const auto tile = parseMove(moveCopy, options.size).first;
+                if (!tile.isNull() && board.board.belongsTo(tile) != Colour::None)
+                    return forfeit;
+                if (!board.tryMakeMove(tile))
+                    return forfeit;
+            }
+            catch (const std::logic_error&)
+            {
+                return forfeit;
+            }
+
+            engines[1 - mover]->send("play " + moveStr);
+        }
+
+        const auto score = board.board.getScore(options.komi);
+        if (score == 0)
+            return 0.5;
+
+        return (score > 0) == firstIsBlack ? 1.0 : 0.0;
+    }
+}
+
+std::uint32_t runMatch(const MatchOptions& options)
+{
+    const auto openings = loadOpenings(options);
+    const auto lower = std::log(options.beta / (1.0 - options.alpha));
+    const auto upper = std::log((1.0 - options.beta) / options.alpha);
+
+    std::mutex lock{};
+    Tally tally{};
+    std::uint32_t nextGame = 0;
+    auto decided = false;
+
+    const auto work = [&] {
+        std::array<std::unique_ptr<EngineProcess>, 2> engines{};
+
+        while (true)
+        {
+            std::uint32_t game = 0;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (decided || nextGame >= options.games)
+                    return;
+                game = nextGame++;
+            }
+
+            // colours alternate, and each opening is played from both sides
+            const auto firstIsBlack = game % 2 == 0;
+            const auto& opening = openings[(game / 2) % openings.size()];
+
+            std::array<SideStats, 2> sides{};
+            auto result = 0.5;
+
+            try
+            {
+                for (std::size_t i = 0; i < engines.size(); i++)
+                    if (!engines[i])
+                        engines[i] = std::make_unique<EngineProcess>(options.engines[i]);
+
+                result = playGame(options, engines, firstIsBlack, opening, sides);
+            }
+            catch (const std::exception& error)
+            {
+                // restart both engines and leave this game out
+                std::lock_guard<std::mutex> guard(lock);
+                std::cout << "game " << game + 1 << " aborted, " << error.what() << std::endl;
+                engines[0].reset();
+                engines[1].reset();
+                continue;
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+
+            tally.wins += result == 1.0;
+            tally.draws += result == 0.5;
+            tally.losses += result == 0.0;
+            for (std::size_t i = 0; i < sides.size(); i++)
+            {
+                tally.sides[i].moves += sides[i].moves;
+                tally.sides[i].time += sides[i].time;
+                tally.sides[i].nodes += sides[i].nodes;
+                tally.sides[i].searchTime += sides[i].searchTime;
+            }
+
+            const auto llr = logLikelihoodRatio(tally, options);
+            decided = llr <= lower || llr >= upper;
+
+            std::cout << "game " << game + 1 << " result " << result;
+            std::cout << " wdl " << tally.wins << "-" << tally.draws << "-" << tally.losses;
+            std::cout << " llr " << llr << " (" << lower << ", " << upper << ")" << std::endl;
+        }
+    };
+
+    {
+        std::vector<std::thread> workers{};
+        for (std::size_t i = 0; i < std::max<std::size_t>(options.threads, 1); i++)
+            workers.emplace_back(work);
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    if (tally.games() == 0)
+        return 0;
+
+    const auto score = tally.score();
+    const auto llr = logLikelihoodRatio(tally, options);
+
+    std::cout << "games " << tally.games() << " wdl " << tally.wins << "-" << tally.draws << "-" << tally.losses;
+    std::cout << " score " << 100.0 * score << "%";
+
+    if (score > 0.0 && score < 1.0)
+    {
+        // 95% interval, through the slope of the logistic curve at the score
+        const auto margin = 1.96 * std::sqrt(tally.variance() / tally.games());
+        const auto eloMargin = 400.0 / std::log(10.0) * margin / (score * (1.0 - score));
+        std::cout << " elo " << eloOf(score) << " +- " << eloMargin;
+    }
+
+    std::cout << " sprt ";
+    if (llr >= upper)
+        std::cout << "accepted H1 (elo >= " << options.elo1 << ")";
+    else if (llr <= lower)
+        std::cout << "accepted H0 (elo <= " << options.elo0 << ")";
+    else
+        std::cout << "inconclusive";
+    std::cout << std::endl;
+
+    for (std::size_t i = 0; i < tally.sides.size(); i++)
+    {
+        const auto& side = tally.sides[i];
+        const auto moves = side.moves ? side.moves : 1;
+        const auto nps = side.searchTime > 0 ? 1000 * side.nodes / static_cast<std::uint64_t>(side.searchTime) : 0;
+
+        std::cout << "engine " << i + 1 << " moves " << side.moves;
+        std::cout << " ms/move " << static_cast<double>(side.time) / moves;
+        std::cout << " nps " << nps << std::endl;
+    }
+
+    return tally.games();
+}
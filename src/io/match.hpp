@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+struct MatchOptions
+{
+    // shell commands starting each engine, so two option sets of the same
+    // binary are just two command lines
+    std::array<std::string, 2> engines{};
+    std::uint32_t games = 100;
+    std::size_t threads = 1;
+    std::uint16_t size = 9;
+    float komi = 7.5;
+    std::int32_t secondsPerMove = 1;
+    // file of openings, one line of space separated moves each, with a
+    // small built in set used when empty
+    std::string openings{};
+    // SPRT hypotheses on the Elo of the first engine over the second
+    double elo0 = 0.0;
+    double elo1 = 10.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+};
+
+// Plays the first engine against the second over GTP, alternating colours
+// and playing every opening once with each, on `options.threads` games at
+// a time. Stops early once the SPRT accepts either hypothesis. Returns the
+// number of games played.
+std::uint32_t runMatch(const MatchOptions& options);
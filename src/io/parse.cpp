@@ -79,4 +79,96 @@ std::string tileToString(Tile tile, std::uint16_t size)
         column++;
 
     return static_cast<char>(97 + column) + std::to_string(row + 1);
+}
+
+std::string tileToSgf(Tile tile, std::uint16_t size)
+{
+    if (tile.isNull())
+        return "";
+
+    const auto column = tile.index() % size;
+    const auto row = size - 1 - tile.index() / size;
+
+    return std::string{static_cast<char>(97 + column), static_cast<char>(97 + row)};
+}
+
+bool parseSgf(std::string_view text, std::size_t& pos, SgfGame& game)
+{
+    game = SgfGame{};
+
+    pos = text.find('(', pos);
+    if (pos == std::string_view::npos)
+        return false;
+
+    auto depth = 0;
+    auto mainLineDone = false;
+    std::string_view ident{};
+
+    while (pos < text.size())
+    {
+        const auto c = text[pos];
+
+        if (c == '[')
+        {
+            // property value, where `\` escapes the next character
+            const auto start = ++pos;
+            while (pos < text.size() && text[pos] != ']')
+                pos += text[pos] == '\\' ? 2 : 1;
+
+            const auto value = text.substr(start, pos - start);
+            pos++;
+
+            if (mainLineDone)
+                continue;
+
+            if (ident == "B" || ident == "W")
+                game.moves.push_back({ident == "B" ? Colour::Black : Colour::White, value});
+            else if (ident == "AB" || ident == "AW")
+                game.setup.push_back({ident == "AB" ? Colour::Black : Colour::White, value});
+            else if (ident == "SZ")
+                game.size = static_cast<std::uint16_t>(std::stoi(std::string(value)));
+            else if (ident == "KM")
+                game.komi = std::stof(std::string(value));
+            else if (ident == "RE")
+                game.result = value;
+
+            continue;
+        }
+
+        pos++;
+
+        if (c == '(')
+            depth++;
+        else if (c == ')')
+        {
+            // the first variation to close ends the main line
+            mainLineDone = true;
+            if (--depth == 0)
+                return true;
+        }
+        else if (c >= 'A' && c <= 'Z')
+        {
+            const auto start = pos - 1;
+            while (pos < text.size() && text[pos] >= 'A' && text[pos] <= 'Z')
+                pos++;
+            ident = text.substr(start, pos - start);
+        }
+    }
+
+    return true;
+}
+
+Tile sgfToTile(std::string_view point, std::uint16_t size)
+{
+    // an empty point, or "tt" on boards up to 19x19, is a pass
+    if (point.size() < 2 || (size <= 19 && point == "tt"))
+        return Tile{};
+
+    const auto column = point[0] - 'a';
+    const auto row = point[1] - 'a';
+
+    if (column < 0 || column >= size || row < 0 || row >= size)
+        throw std::invalid_argument("out of board bounds");
+
+    return Tile(column, size - 1 - row, size);
 }
\ No newline at end of file
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <sstream>
+#include <string_view>
+#include <vector>
 
 #include "../state/core.hpp"
 
+void makeLower(std::string& str);
+
 Colour parseColour(std::string& str);
 
 std::pair<std::string, std::string> splitAt(const std::string &str, char delim);
@@ -11,3 +15,25 @@ std::pair<std::string, std::string> splitAt(const std::string &str, char delim);
 std::pair<Tile, Colour> parseMove(std::string &moveStr, std::uint16_t size);
 
 std::string tileToString(Tile tile, std::uint16_t size);
+
+// SGF point, columns left to right and rows top to bottom from 'a', and
+// empty for a pass.
+std::string tileToSgf(Tile tile, std::uint16_t size);
+
+// The main line of one SGF game. Points are views into the parsed text,
+// so it must outlive the game.
+struct SgfGame
+{
+    std::uint16_t size = 19;
+    float komi = 0.0;
+    std::string_view result{};
+    std::vector<std::pair<Colour, std::string_view>> setup{};
+    std::vector<std::pair<Colour, std::string_view>> moves{};
+};
+
+// Parses the game starting at or after `pos` in an SGF collection, leaving
+// `pos` after it. Variations other than the first are skipped. Returns
+// false once there are no more games.
+bool parseSgf(std::string_view text, std::size_t& pos, SgfGame& game);
+
+Tile sgfToTile(std::string_view point, std::uint16_t size);
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <csignal>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "process.hpp"
+
+#if !defined(_WIN32)
+namespace {
+    // Both ends are closed on exec, so engines started later, possibly
+    // by other threads, do not inherit them. pipe2 sets this atomically.
+    bool openPipe(int (&fds)[2])
+    {
+#if defined(__linux__)
+        return pipe2(fds, O_CLOEXEC) == 0;
+#else
+        if (pipe(fds) != 0)
+            return false;
+
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return true;
+#endif
+    }
+
+    void closePipe(int (&fds)[2])
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+}
+
+EngineProcess::EngineProcess(const std::string& command)
+{
+    // a dead engine must not take the caller down with it
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int input[2];
+    int output[2];
+    if (!openPipe(input))
+        throw std::runtime_error("cannot create pipes");
+
+    if (!openPipe(output))
+    {
+        closePipe(input);
+        throw std::runtime_error("cannot create pipes");
+    }
+
+    pid = fork();
+    if (pid < 0)
+    {
+        closePipe(input);
+        closePipe(output);
+        throw std::runtime_error("cannot start " + command);
+    }
+
+    if (pid == 0)
+    {
+        dup2(input[0], STDIN_FILENO);
+        dup2(output[1], STDOUT_FILENO);
+        close(input[0]);
+        close(input[1]);
+        close(output[0]);
+        close(output[1]);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    close(input[0]);
+    close(output[1]);
+    toEngine = fdopen(input[1], "w");
+    fromEngine = fdopen(output[0], "r");
+
+    if (toEngine == nullptr || fromEngine == nullptr)
+    {
+        // closing its input lets the engine exit before it is reaped
+        toEngine != nullptr ? std::fclose(toEngine) : close(input[1]);
+        fromEngine != nullptr ? std::fclose(fromEngine) : close(output[0]);
+        waitpid(pid, nullptr, 0);
+        throw std::runtime_error("cannot start " + command);
+    }
+}
+
+EngineProcess::~EngineProcess()
+{
+    if (toEngine != nullptr)
+    {
+        std::fputs("quit\n", toEngine);
+        std::fclose(toEngine);
+    }
+
+    if (fromEngine != nullptr)
+        std::fclose(fromEngine);
+
+    if (pid > 0)
+        waitpid(pid, nullptr, 0);
+}
+
+bool EngineProcess::readLine(std::string& line)
+{
+    line.clear();
+
+    for (int c = std::fgetc(fromEngine); c != EOF; c = std::fgetc(fromEngine))
+    {
+        if (c == '\n')
+            return true;
+        if (c != '\r')
+            line += static_cast<char>(c);
+    }
+
+    return !line.empty();
+}
+#else
+EngineProcess::EngineProcess(const std::string& command)
+{
+    throw std::runtime_error("cannot start " + command + ", engine processes need a POSIX platform");
+}
+
+EngineProcess::~EngineProcess() {}
+
+bool EngineProcess::readLine(std::string& line)
+{
+    line.clear();
+    return false;
+}
+#endif
+
+std::string EngineProcess::send(const std::string& command, std::vector<std::string>* info)
+{
+    if (std::fputs((command + "\n").c_str(), toEngine) < 0 || std::fflush(toEngine) != 0)
+        throw std::runtime_error("engine closed its input");
+
+    std::string line{};
+    std::string response{};
+    auto status = ' ';
+
+    while (readLine(line))
+    {
+        if (status == ' ')
+        {
+            if (line.empty())
+                continue;
+
+            if (line[0] == '#')
+            {
+                if (info != nullptr)
+                    info->push_back(line);
+                continue;
+            }
+
+            status = line[0];
+            const auto start = line.find(' ');
+            response = start == std::string::npos ? "" : line.substr(start + 1);
+        }
+        else if (line.empty())
+        {
+            if (status != '=')
+                throw std::runtime_error("engine failed: " + response);
+
+            return response;
+        }
+        else
+            response += "\n" + line;
+    }
+
+    throw std::runtime_error("engine exited");
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// A GTP engine running as a child process, talked to over a pair of pipes.
+// Only supported on POSIX platforms.
+class EngineProcess
+{
+    public:
+        // runs `command` through the shell
+        explicit EngineProcess(const std::string& command);
+
+        ~EngineProcess();
+
+        EngineProcess(const EngineProcess&) = delete;
+        EngineProcess& operator=(const EngineProcess&) = delete;
+
+        // Sends one command and returns the response without its status,
+        // collecting any '#' comment lines printed before it into `info`.
+        // Throws if the engine reports a failure or has died.
+        std::string send(const std::string& command, std::vector<std::string>* info = nullptr);
+
+    private:
+        bool readLine(std::string& line);
+
+        int pid = -1;
+        std::FILE* toEngine = nullptr;
+        std::FILE* fromEngine = nullptr;
+};
@@ -0,0 +1,111 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include "../mcts/mcts.hpp"
+#include "../mcts/pool.hpp"
+#include "parse.hpp"
+#include "selfplay.hpp"
+
+namespace {
+    std::uint64_t nextRandom(std::uint64_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    Tile randomMove(Board& board, std::uint64_t& rng)
+    {
+        std::vector<Tile> moves{};
+        const auto head = board.board.moveHead();
+        for (auto move = head.first; !move.isNull(); move = board.board[move].next)
+        {
+            if (board.tryMakeMove(move))
+            {
+                moves.push_back(move);
+                board.undoMove();
+            }
+        }
+
+        return moves.empty() ? Tile{} : moves[nextRandom(rng) % moves.size()];
+    }
+
+    std::string playGame(const SelfPlayOptions& options, std::uint64_t seed)
+    {
+        Mcts searcher{};
+        searcher.logging = false;
+        searcher.board = Board(options.size);
+        searcher.board.setKomi(options.komi);
+        searcher.timer = Timer::unlimited();
+        searcher.setNodes(options.rollouts);
+        searcher.setSeed(seed);
+
+        auto rng = seed;
+        auto& board = searcher.board;
+
+        std::string moves{};
+        const auto maxMoves = static_cast<std::size_t>(3 * board.board.sizeOf());
+
+        while (!board.board.isGameOver() && board.plies() < maxMoves)
+        {
+            const auto colour = board.sideToMove() == Colour::Black ? "B" : "W";
+            const auto move = board.plies() < options.randomMoves ? randomMove(board, rng) : searcher.search();
+
+            board.makeMove(move);
+            moves += ";" + std::string(colour) + "[" + tileToSgf(move, options.size) + "]";
+        }
+
+        const auto score = board.board.getScore(options.komi);
+
+        std::ostringstream sgf{};
+        sgf << "(;GM[1]FF[4]CA[UTF-8]AP[Gotcha]SZ[" << options.size << "]KM[" << options.komi << "]";
+        // a game cut off at the move cap has no result, and a jigo is RE[0]
+        if (!board.board.isGameOver())
+            sgf << "RE[Void]";
+        else if (score == 0)
+            sgf << "RE[0]";
+        else
+            sgf << "RE[" << (score > 0 ? "B+" : "W+") << std::abs(score) << "]";
+        sgf << moves << ")";
+
+        return sgf.str();
+    }
+}
+
+std::uint32_t runSelfPlay(const SelfPlayOptions& options, const std::string& path)
+{
+    std::ofstream out(path, std::ios::app);
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+
+    std::mutex outputLock{};
+    std::uint32_t finished = 0;
+
+    {
+        ThreadPool pool(options.threads);
+
+        for (std::uint32_t i = 0; i < options.games; i++)
+        {
+            // xorshift state must be non-zero
+            const auto seed = options.seed * UINT64_C(0x9E3779B97F4A7C15) + i + 1;
+
+            pool.submit([&, seed] {
+                const auto record = playGame(options, seed);
+
+                std::lock_guard<std::mutex> guard(outputLock);
+                out << record << std::endl;
+                finished++;
+                std::cout << "game " << finished << "/" << options.games << std::endl;
+            });
+        }
+
+        pool.wait();
+    }
+
+    return finished;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct SelfPlayOptions
+{
+    std::uint32_t games = 1;
+    std::size_t threads = 1;
+    std::uint16_t size = 9;
+    float komi = 7.5;
+    std::int32_t rollouts = 400;
+    // number of opening moves played uniformly at random
+    std::uint16_t randomMoves = 4;
+    std::uint64_t seed = 1;
+};
+
+// Plays `options.games` games of the engine against itself, spread over a
+// pool of `options.threads` workers, and appends each finished game to
+// `path` as a single line SGF record. Returns the number of games written.
+std::uint32_t runSelfPlay(const SelfPlayOptions& options, const std::string& path);
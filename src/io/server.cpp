@@ -0,0 +1,116 @@
+#include <iostream>
+
+#include "parse.hpp"
+#include "server.hpp"
+
+GtpServer::GtpServer(std::size_t threads) : leafPool(std::make_shared<ThreadPool>(threads)), pool(threads) {}
+
+void GtpServer::run()
+{
+    for (std::string line{}; std::getline(std::cin, line);)
+    {
+        auto gameId = std::string("0");
+        auto command = line;
+
+        if (!line.empty() && line[0] == '@')
+        {
+            const auto [tag, rest] = splitAt(line.substr(1), ' ');
+            gameId = tag;
+            command = rest;
+        }
+
+        // an untagged quit shuts down the server once every game is idle
+        if (command == "quit" && gameId == "0" && line[0] != '@')
+            break;
+
+        dispatch(gameId, command);
+    }
+
+    pool.wait();
+}
+
+void GtpServer::dispatch(const std::string& gameId, const std::string& command)
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    // forget games that have quit and finished their last command
+    for (auto it = games.begin(); it != games.end();)
+    {
+        if (it->second->closed && !it->second->busy)
+            it = games.erase(it);
+        else
+            it++;
+    }
+
+    auto& slot = games[gameId];
+    if (!slot)
+    {
+        slot = std::make_unique<Game>();
+        slot->runner.setOutput(slot->output);
+        slot->runner.setLogging(false);
+        slot->runner.setLeafPool(leafPool);
+
+        // analysis streams straight out from its own thread, so that it
+        // never shares the game's buffer with the command being drained
+        slot->runner.setAnalysisOutput([this, gameId](const std::string& text) {
+            std::lock_guard<std::mutex> guard(outputLock);
+            // the blank line ending a response is not tagged
+            if (text != "\n")
+                std::cout << "@" << gameId << " ";
+            std::cout << text << std::flush;
+        });
+        if (book)
+            slot->runner.setBook(book, bookPlies);
+    }
+
+    auto& game = *slot;
+    game.queue.push_back(command);
+
+    if (game.busy)
+        return;
+
+    game.busy = true;
+    pool.submit([this, gameId, &game] { drain(gameId, game); });
+}
+
+void GtpServer::drain(const std::string& gameId, Game& game)
+{
+    while (true)
+    {
+        std::string command;
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (game.queue.empty())
+            {
+                game.busy = false;
+                return;
+            }
+
+            command = game.queue.front();
+            game.queue.pop_front();
+        }
+
+        // quitting a game only closes that game
+        const auto tokens = splitAt(command, ' ');
+        if (tokens.first == "quit" || tokens.second == "quit")
+        {
+            game.runner.stopAnalysis();
+
+            std::lock_guard<std::mutex> guard(lock);
+            game.closed = true;
+            game.output << "=" << (tokens.first == "quit" ? "" : tokens.first) << " \n" << std::endl;
+        }
+        else
+            game.runner.execute(command);
+
+        const auto response = game.output.str();
+        game.output.str("");
+
+        if (response.empty())
+            continue;
+
+        std::lock_guard<std::mutex> guard(outputLock);
+        std::cout << "@" << gameId << " " << response << std::flush;
+    }
+}
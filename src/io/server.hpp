@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "../mcts/pool.hpp"
+#include "gtp.hpp"
+
+// Hosts many games in one process. Each line is a GTP command prefixed by
+// the id of the game it is for, as in `@<game> [id] <command>` (untagged
+// lines go to game "0"), and every response is prefixed the same way.
+// Each game has its own board and search tree, and the commands of all
+// games are run by one shared pool of worker threads, one at a time per
+// game and in the order they arrived. Games searching with `leafthreads`
+// share a second pool of the same size for their rollouts.
+class GtpServer
+{
+    public:
+        explicit GtpServer(std::size_t threads);
+
+        void run();
+
+        void setBook(std::shared_ptr<const OpeningBook> openingBook, std::size_t plies)
+        {
+            book = std::move(openingBook);
+            bookPlies = plies;
+        }
+
+    private:
+        struct Game
+        {
+            GtpRunner runner{};
+            std::ostringstream output{};
+            std::deque<std::string> queue{};
+            bool busy = false;
+            bool closed = false;
+        };
+
+        void dispatch(const std::string& gameId, const std::string& command);
+
+        void drain(const std::string& gameId, Game& game);
+
+        // games outlive the pool, and the locks outlive the analysis
+        // threads that games stop as they are destroyed
+        std::mutex lock{};
+        std::mutex outputLock{};
+        std::unordered_map<std::string, std::unique_ptr<Game>> games{};
+        std::shared_ptr<const OpeningBook> book{};
+        std::size_t bookPlies{};
+        // leaf rollouts of every game, apart from the pool that runs their
+        // commands, whose tasks wait on them
+        std::shared_ptr<ThreadPool> leafPool;
+        ThreadPool pool;
+};
@@ -0,0 +1,86 @@
+#include <filesystem>
+#include <stdexcept>
+
+#include "mapped.hpp"
+#include "sgf.hpp"
+
+Board replaySgf(const SgfGame& game, std::size_t numMoves)
+{
+    auto board = Board(game.size);
+    board.setKomi(game.komi);
+
+    // setup stones skip every check, so at least keep them on empty points
+    for (const auto& [colour, point] : game.setup)
+    {
+        const auto tile = sgfToTile(point, game.size);
+        if (tile.isNull() || board.board.belongsTo(tile) != Colour::None)
+            throw std::invalid_argument("bad setup point in record");
+
+        board.place(tile, colour);
+    }
+
+    // played for real, so that the history sees ko and superko
+    for (std::size_t i = 0; i < numMoves && i < game.moves.size(); i++)
+    {
+        const auto& [colour, point] = game.moves[i];
+        const auto tile = sgfToTile(point, game.size);
+        const auto occupied = !tile.isNull() && board.board.belongsTo(tile) != Colour::None;
+
+        board.setStm(colour);
+        if (occupied || !board.tryMakeMove(tile))
+            throw std::invalid_argument("illegal move " + std::to_string(i + 1) + " in record");
+    }
+
+    // the side to move is whoever plays next in the record
+    if (numMoves < game.moves.size())
+        board.setStm(game.moves[numMoves].first);
+
+    return board;
+}
+
+SgfScan replayDirectory(const std::string& dir, const std::function<void(const Board&, Tile)>& visit)
+{
+    SgfScan scan{};
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".sgf")
+            continue;
+
+        const MappedFile file(entry.path().string());
+        const auto text = std::string_view(file.data(), file.size());
+        scan.files++;
+
+        SgfGame game{};
+        for (std::size_t pos = 0; pos < text.size();)
+        {
+            try
+            {
+                if (!parseSgf(text, pos, game))
+                    break;
+
+                if (game.size > 25)
+                    throw std::invalid_argument("unsupported board size");
+
+                auto board = replaySgf(game, 0);
+                for (const auto& [colour, point] : game.moves)
+                {
+                    // replayMove trusts the point, so a bad record must stop here
+                    const auto tile = sgfToTile(point, game.size);
+                    if (!tile.isNull() && board.board.belongsTo(tile) != Colour::None)
+                        throw std::invalid_argument("move onto an occupied point");
+
+                    board.setStm(colour);
+                    visit(board, tile);
+                    board.replayMove(tile, colour);
+                }
+
+                scan.games++;
+                scan.moves += game.moves.size();
+            }
+            catch(...) { scan.errors++; }
+        }
+    }
+
+    return scan;
+}
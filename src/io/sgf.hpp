@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "../state/board.hpp"
+#include "parse.hpp"
+
+// Sets up `game` on a new board, playing its first `numMoves` moves with
+// full history, and throws std::invalid_argument if one is illegal.
+Board replaySgf(const SgfGame& game, std::size_t numMoves);
+
+struct SgfScan
+{
+    std::uint64_t files{};
+    std::uint64_t games{};
+    std::uint64_t moves{};
+    std::uint64_t errors{};
+};
+
+// Replays every game of every `.sgf` file under `dir`, calling `visit` with
+// the position before each move and the move played.
+SgfScan replayDirectory(const std::string& dir, const std::function<void(const Board&, Tile)>& visit);
@@ -0,0 +1,186 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "../mcts/mcts.hpp"
+#include "../mcts/pool.hpp"
+#include "parse.hpp"
+#include "suite.hpp"
+
+namespace {
+    struct SuitePosition
+    {
+        std::size_t line = 0;
+        Board board{};
+        Tile expected{};
+        bool hasExpected = false;
+    };
+
+    struct SuiteResult
+    {
+        Tile move{};
+        float winrate = 0.0;
+        std::uint64_t nodes = 0;
+        std::int64_t time = 0;
+    };
+
+    SuitePosition parsePosition(const std::string& line)
+    {
+        std::istringstream fields(line);
+
+        int size = 0;
+        float komi = 0.0;
+        std::string stm{};
+        if (!(fields >> size >> komi >> stm) || size < 2 || size > 25)
+            throw std::invalid_argument("bad position header");
+
+        SuitePosition position{};
+        position.board = Board(size);
+        position.board.setKomi(komi);
+
+        for (std::string token{}; fields >> token;)
+        {
+            auto [prefix, vertex] = splitAt(token, ':');
+            auto moveStr = (prefix == "bm" ? "b" : prefix) + " " + vertex;
+            const auto [tile, colour] = parseMove(moveStr, size);
+
+            if (prefix == "bm")
+            {
+                position.expected = tile;
+                position.hasExpected = true;
+            }
+            else
+            {
+                if (tile.isNull())
+                    throw std::invalid_argument("cannot place a pass");
+                if (position.board.board.belongsTo(tile) != Colour::None)
+                    throw std::invalid_argument("point placed twice");
+
+                // a stone that captures or has no liberties is not a position
+                const auto before = position.board.stones();
+                position.board.place(tile, colour);
+                const auto after = position.board.stones();
+
+                const auto own = static_cast<std::size_t>(colour);
+                if (after[own] != before[own] + 1 || after[1 - own] != before[1 - own])
+                    throw std::invalid_argument("placed stone captures or is suicide");
+            }
+        }
+
+        position.board.setStm(parseColour(stm));
+
+        return position;
+    }
+
+    SuiteResult searchPosition(const SuiteOptions& options, const SuitePosition& position)
+    {
+        Mcts searcher{};
+        searcher.logging = false;
+        searcher.board = position.board;
+        searcher.timer = options.moveTime > 0 ? Timer::perMove(options.moveTime) : Timer::unlimited();
+        searcher.setNodes(options.rollouts);
+        searcher.setSeed(options.seed);
+
+        const auto clockStart = std::chrono::steady_clock::now();
+
+        SuiteResult result{};
+        result.move = searcher.search();
+
+        const auto dur = std::chrono::steady_clock::now() - clockStart;
+        result.time = std::chrono::duration_cast<std::chrono::milliseconds>(dur).count();
+        result.nodes = searcher.board.nodes;
+
+        for (const auto& rootMove : searcher.rootMoves())
+            if (rootMove.move == result.move)
+                result.winrate = rootMove.winrate;
+
+        return result;
+    }
+}
+
+std::uint32_t runSuite(const SuiteOptions& options, const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("cannot read " + path);
+
+    std::vector<SuitePosition> positions{};
+
+    auto lineNum = std::size_t{0};
+    for (std::string line{}; std::getline(in, line);)
+    {
+        lineNum++;
+        if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        try
+        {
+            positions.push_back(parsePosition(line));
+            positions.back().line = lineNum;
+        }
+        catch(...)
+        {
+            std::cout << "line " << lineNum << " skipped, cannot parse position" << std::endl;
+        }
+    }
+
+    std::vector<SuiteResult> results(positions.size());
+
+    const auto clockStart = std::chrono::steady_clock::now();
+
+    {
+        ThreadPool pool(options.threads);
+
+        // each task writes only its own slot, so no locking is needed
+        for (std::size_t i = 0; i < positions.size(); i++)
+            pool.submit([&, i] { results[i] = searchPosition(options, positions[i]); });
+
+        pool.wait();
+    }
+
+    const auto dur = std::chrono::steady_clock::now() - clockStart;
+    const auto wall = std::chrono::duration_cast<std::chrono::milliseconds>(dur).count();
+
+    std::uint64_t totalNodes = 0;
+    std::uint32_t solved = 0;
+    std::uint32_t withExpected = 0;
+
+    for (std::size_t i = 0; i < positions.size(); i++)
+    {
+        const auto& position = positions[i];
+        const auto& result = results[i];
+        const auto size = position.board.size();
+        const auto nps = result.time > 0 ? 1000 * result.nodes / static_cast<std::uint64_t>(result.time) : result.nodes;
+
+        totalNodes += result.nodes;
+
+        std::cout << "line " << position.line;
+        std::cout << " bestmove " << tileToString(result.move, size);
+        std::cout << " winrate " << 100.0 * result.winrate << "%";
+        std::cout << " nodes " << result.nodes;
+        std::cout << " time " << result.time;
+        std::cout << " nps " << nps;
+
+        if (position.hasExpected)
+        {
+            const auto correct = result.move == position.expected;
+            withExpected++;
+            solved += correct;
+            std::cout << " expected " << tileToString(position.expected, size) << (correct ? " ok" : " fail");
+        }
+
+        std::cout << std::endl;
+    }
+
+    const auto nps = wall > 0 ? 1000 * totalNodes / static_cast<std::uint64_t>(wall) : totalNodes;
+
+    std::cout << "positions " << positions.size();
+    if (withExpected)
+        std::cout << " solved " << solved << "/" << withExpected;
+    std::cout << " nodes " << totalNodes << " time " << wall << " nps " << nps << std::endl;
+
+    return static_cast<std::uint32_t>(positions.size());
+}
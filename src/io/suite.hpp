@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// A position file holds one position per line,
+//
+//     <size> <komi> <b|w to move> [b:<vertex> | w:<vertex> | bm:<vertex>]...
+//
+// giving the stones of each colour and optionally the expected best move.
+// Blank lines and lines starting with '#' are skipped.
+struct SuiteOptions
+{
+    std::size_t threads = 1;
+    std::int32_t rollouts = 1000;
+    // per position limit in milliseconds, 0 for rollouts only
+    std::int64_t moveTime = 0;
+    std::uint64_t seed = 1;
+};
+
+// Searches every position in `path`, spread over a pool of `options.threads`
+// workers, and prints one result line per position in file order followed
+// by a summary. Returns the number of positions searched.
+std::uint32_t runSuite(const SuiteOptions& options, const std::string& path);
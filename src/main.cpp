@@ -1,9 +1,174 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <string>
 
+#include "io/bench.hpp"
 #include "io/gtp.hpp"
+#include "io/match.hpp"
+#include "io/selfplay.hpp"
+#include "io/sgf.hpp"
+#include "io/server.hpp"
+#include "io/suite.hpp"
+#include "mcts/numa.hpp"
 
-int main()
+int main(int argc, char* argv[])
 {
+    // --pin, anywhere, binds pool workers and the GTP search thread to
+    // cores spread over NUMA nodes
+    std::vector<char*> args(argv, argv + argc);
+    const auto pinFlag = std::find(args.begin(), args.end(), std::string("--pin"));
+    if (pinFlag != args.end())
+    {
+        args.erase(pinFlag);
+        argc = static_cast<int>(args.size());
+        argv = args.data();
+        setPinning(true);
+
+        const auto& layout = cpuLayout();
+        // node numbers can have gaps, so count the distinct ones
+        std::vector<int> nodes{};
+        for (const auto& placement : layout)
+            if (std::find(nodes.begin(), nodes.end(), placement.node) == nodes.end())
+                nodes.push_back(placement.node);
+
+        std::cerr << "# pinning to " << layout.size() << " cpus on " << nodes.size() << " nodes" << std::endl;
+    }
+
+    const auto mode = argc > 1 ? std::string(argv[1]) : "";
+
+    if (mode == "bench")
+    {
+        std::cout << runBench().report << std::endl;
+        return 0;
+    }
+
+    // makebook <file> <size> <plies> <rollouts> [width]
+    if (mode == "makebook" && argc >= 6)
+    {
+        const auto width = argc > 6 ? std::stoi(argv[6]) : 3;
+        const auto entries = buildBook(argv[2], std::stoi(argv[3]), 7.5, std::stoi(argv[4]), std::stoi(argv[5]), width);
+        std::cout << "wrote " << entries << " entries" << std::endl;
+        return 0;
+    }
+
+    // server <threads> [book] [plies]
+    if (mode == "server" && argc >= 3)
+    {
+        GtpServer server(std::stoul(argv[2]));
+
+        if (argc >= 4)
+        {
+            try
+            {
+                const auto plies = argc > 4 ? std::stoul(argv[4]) : GtpRunner::DefaultBookPlies;
+                server.setBook(std::make_shared<const OpeningBook>(argv[3]), plies);
+            }
+            catch(const std::exception& err)
+            {
+                std::cerr << "usage: server <threads> [book] [plies] (" << err.what() << ")" << std::endl;
+                return 1;
+            }
+        }
+
+        server.run();
+        return 0;
+    }
+
+    // selfplay <games> <threads> <file> [size] [komi] [rollouts] [random moves] [seed]
+    if (mode == "selfplay" && argc >= 5)
+    {
+        SelfPlayOptions options{};
+        options.games = std::stoul(argv[2]);
+        options.threads = std::stoul(argv[3]);
+        if (argc > 5) options.size = std::stoi(argv[5]);
+        if (argc > 6) options.komi = std::stof(argv[6]);
+        if (argc > 7) options.rollouts = std::stoi(argv[7]);
+        if (argc > 8) options.randomMoves = std::stoi(argv[8]);
+        if (argc > 9) options.seed = std::stoull(argv[9]);
+
+        const auto games = runSelfPlay(options, argv[4]);
+        std::cout << "wrote " << games << " games" << std::endl;
+        return 0;
+    }
+
+    // match <engine> <engine> <games> <threads> [size] [seconds per move] [openings]
+    if (mode == "match" && argc >= 6)
+    {
+        MatchOptions options{};
+        options.engines = {argv[2], argv[3]};
+        options.games = std::stoul(argv[4]);
+        options.threads = std::stoul(argv[5]);
+        if (argc > 6) options.size = std::stoi(argv[6]);
+        if (argc > 7) options.secondsPerMove = std::stoi(argv[7]);
+        if (argc > 8) options.openings = argv[8];
+
+        runMatch(options);
+        return 0;
+    }
+
+    // suite <file> <threads> [rollouts] [ms per position] [seed]
+    if (mode == "suite" && argc >= 4)
+    {
+        SuiteOptions options{};
+        options.threads = std::stoul(argv[3]);
+        if (argc > 4) options.rollouts = std::stoi(argv[4]);
+        if (argc > 5) options.moveTime = std::stoll(argv[5]);
+        if (argc > 6) options.seed = std::stoull(argv[6]);
+
+        runSuite(options, argv[2]);
+        return 0;
+    }
+
+    // sgfstats <dir>
+    if (mode == "sgfstats" && argc >= 3)
+    {
+        std::uint64_t nearLast = 0;
+        const auto clockStart = std::chrono::steady_clock::now();
+
+        const auto scan = replayDirectory(argv[2], [&](const Board& board, Tile move) {
+            const auto last = board.lastMove(0);
+            if (move.isNull() || last.isNull())
+                return;
+
+            const auto dx = std::abs(move.index() % board.size() - last.index() % board.size());
+            const auto dy = std::abs(move.index() / board.size() - last.index() / board.size());
+            nearLast += std::max(dx, dy) <= 2;
+        });
+
+        const auto dur = std::chrono::steady_clock::now() - clockStart;
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(dur).count();
+
+        std::cout << "files " << scan.files << " games " << scan.games << " moves " << scan.moves;
+        std::cout << " errors " << scan.errors << " time " << ms;
+        std::cout << " moves/s " << (ms > 0 ? 1000 * scan.moves / ms : scan.moves);
+        std::cout << " near last move " << (scan.moves ? 100.0 * nearLast / scan.moves : 0.0) << "%" << std::endl;
+        return 0;
+    }
+
     GtpRunner gtp{};
+
+    // book <file> [plies]
+    if (mode == "book" && argc >= 3)
+    {
+        try
+        {
+            const auto plies = argc > 3 ? std::stoul(argv[3]) : GtpRunner::DefaultBookPlies;
+            gtp.setBook(std::make_shared<const OpeningBook>(argv[2]), plies);
+        }
+        catch(const std::exception& err)
+        {
+            std::cerr << "usage: book <file> [plies] (" << err.what() << ")" << std::endl;
+            return 1;
+        }
+    }
+
+    // the GTP search runs on this thread, and analysis on threads it starts
+    if (pinningEnabled())
+    {
+        const auto placement = pinThread();
+        std::cerr << "# search thread cpu " << placement.cpu << " node " << placement.node << std::endl;
+    }
+
     gtp.run();
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include <cstdint>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+#include "arena.hpp"
+
+namespace {
+    constexpr std::size_t HugePage = std::size_t{2} << 20;
+
+    std::size_t roundUp(std::size_t bytes)
+    {
+        return (bytes + HugePage - 1) / HugePage * HugePage;
+    }
+}
+
+#if !defined(_WIN32)
+void* mapPages(std::size_t bytes)
+{
+    const auto length = roundUp(bytes);
+
+    // over-map by a huge page, then trim either end to leave it aligned
+    auto* mapped = static_cast<char*>(mmap(nullptr, length + HugePage, PROT_READ | PROT_WRITE,
+                                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (mapped == MAP_FAILED)
+        throw std::bad_alloc{};
+
+    const auto address = reinterpret_cast<std::uintptr_t>(mapped);
+    auto* aligned = mapped + (HugePage - address % HugePage) % HugePage;
+
+    if (aligned != mapped)
+        munmap(mapped, static_cast<std::size_t>(aligned - mapped));
+
+    const auto tail = static_cast<std::size_t>(mapped + length + HugePage - (aligned + length));
+    if (tail > 0)
+        munmap(aligned + length, tail);
+
+#if defined(MADV_HUGEPAGE)
+    madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+
+    return aligned;
+}
+
+void unmapPages(void* ptr, std::size_t bytes)
+{
+    munmap(ptr, roundUp(bytes));
+}
+#else
+void* mapPages(std::size_t bytes)
+{
+    return ::operator new(bytes);
+}
+
+void unmapPages(void* ptr, std::size_t)
+{
+    ::operator delete(ptr);
+}
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// Maps whole pages for an allocation of `bytes`, aligned to and asking for
+// transparent huge pages where the platform has them. Pages are backed on
+// first touch, so they land on the NUMA node of the thread that fills them.
+void* mapPages(std::size_t bytes);
+
+void unmapPages(void* ptr, std::size_t bytes);
+
+// Allocator for the big flat arrays of the search, which puts anything of
+// a huge page or more in its own mapping and the rest on the heap.
+template <typename T>
+class PageAllocator
+{
+    public:
+        using value_type = T;
+
+        static constexpr std::size_t MinMapped = std::size_t{2} << 20;
+
+        PageAllocator() = default;
+
+        template <typename U>
+        PageAllocator(const PageAllocator<U>&) {}
+
+        T* allocate(std::size_t n)
+        {
+            const auto bytes = n * sizeof(T);
+            if (bytes < MinMapped)
+                return static_cast<T*>(::operator new(bytes));
+
+            return static_cast<T*>(mapPages(bytes));
+        }
+
+        void deallocate(T* ptr, std::size_t n)
+        {
+            const auto bytes = n * sizeof(T);
+            if (bytes < MinMapped)
+                ::operator delete(ptr);
+            else
+                unmapPages(ptr, bytes);
+        }
+
+        template <typename U>
+        bool operator==(const PageAllocator<U>&) const { return true; }
+
+        template <typename U>
+        bool operator!=(const PageAllocator<U>&) const { return false; }
+};
@@ -0,0 +1,374 @@
+#include "batch.hpp"
+
+namespace {
+    constexpr auto Lanes = BatchPlayout::Lanes;
+
+    struct LaneBits
+    {
+        std::array<std::uint64_t, Lanes> lo{};
+        std::array<std::uint64_t, Lanes> hi{};
+
+        [[nodiscard]] bool empty(std::size_t lane) const { return (lo[lane] | hi[lane]) == 0; }
+    };
+
+    int popCount(std::uint64_t word)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        auto count = 0;
+        for (; word != 0; word &= word - 1)
+            count++;
+        return count;
+#endif
+    }
+
+    int popCount(const LaneBits& bits, std::size_t lane)
+    {
+        return popCount(bits.lo[lane]) + popCount(bits.hi[lane]);
+    }
+
+    std::uint64_t nextRandom(std::uint64_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    // points in or next to `lo:hi`, rows being `stride` bits apart
+    inline void dilate(std::uint64_t lo, std::uint64_t hi, int stride, std::uint64_t& outLo, std::uint64_t& outHi)
+    {
+        outLo = lo | (lo << 1) | (lo >> 1) | (hi << 63) | (lo << stride) | (lo >> stride) | (hi << (64 - stride));
+        outHi = hi | (hi << 1) | (lo >> 63) | (hi >> 1) | (hi << stride) | (lo >> (64 - stride)) | (hi >> stride);
+    }
+
+    LaneBits dilate(const LaneBits& bits, int stride)
+    {
+        LaneBits out{};
+        for (std::size_t l = 0; l < Lanes; l++)
+            dilate(bits.lo[l], bits.hi[l], stride, out.lo[l], out.hi[l]);
+        return out;
+    }
+
+    // the points of `within` connected to `seed`, in every lane at once
+    LaneBits fill(const LaneBits& seed, const LaneBits& within, int stride)
+    {
+        auto grown = seed;
+        for (std::size_t l = 0; l < Lanes; l++)
+        {
+            grown.lo[l] &= within.lo[l];
+            grown.hi[l] &= within.hi[l];
+        }
+
+        for (auto changed = std::uint64_t{1}; changed != 0;)
+        {
+            changed = 0;
+            for (std::size_t l = 0; l < Lanes; l++)
+            {
+                std::uint64_t lo, hi;
+                dilate(grown.lo[l], grown.hi[l], stride, lo, hi);
+                lo &= within.lo[l];
+                hi &= within.hi[l];
+                changed |= (lo ^ grown.lo[l]) | (hi ^ grown.hi[l]);
+                grown.lo[l] = lo;
+                grown.hi[l] = hi;
+            }
+        }
+
+        return grown;
+    }
+
+    // a uniformly random set bit of the lane
+    std::pair<std::uint64_t, std::uint64_t> pickBit(const LaneBits& bits, std::size_t lane, std::uint64_t& random)
+    {
+        const auto lowCount = popCount(bits.lo[lane]);
+        auto idx = static_cast<int>(nextRandom(random) % static_cast<std::uint64_t>(lowCount + popCount(bits.hi[lane])));
+
+        const auto fromLow = idx < lowCount;
+        auto word = fromLow ? bits.lo[lane] : bits.hi[lane];
+        if (!fromLow)
+            idx -= lowCount;
+
+        for (; idx > 0; idx--)
+            word &= word - 1;
+
+        const auto bit = word & (~word + 1);
+        return fromLow ? std::pair{bit, std::uint64_t{0}} : std::pair{std::uint64_t{0}, bit};
+    }
+}
+
+BatchPlayout::BatchPlayout(std::uint16_t size)
+{
+    boardSize = size;
+    stride = size + 1;
+
+    const auto setBit = [](Mask& mask, int bit) {
+        if (bit < 64)
+            mask.lo |= std::uint64_t{1} << bit;
+        else
+            mask.hi |= std::uint64_t{1} << (bit - 64);
+    };
+
+    for (auto rank = 0; rank < size; rank++)
+    {
+        for (auto file = 0; file < size; file++)
+        {
+            const auto bit = rank * stride + file;
+            setBit(onBoard, bit);
+
+            if (rank == size - 1)
+                setBit(edges[0], bit);
+            if (rank == 0)
+                setBit(edges[1], bit);
+            if (file == size - 1)
+                setBit(edges[2], bit);
+            if (file == 0)
+                setBit(edges[3], bit);
+        }
+    }
+
+    for (const auto& edge : edges)
+    {
+        anyEdge.lo |= edge.lo;
+        anyEdge.hi |= edge.hi;
+    }
+}
+
+std::uint32_t BatchPlayout::run(Board& board, std::uint64_t& random, std::vector<std::int32_t>* ownership)
+{
+    const auto& state = board.board;
+    const auto numTiles = static_cast<std::size_t>(state.sizeOf());
+
+    LaneBits black{};
+    LaneBits white{};
+    LaneBits ko{};
+    std::array<std::uint16_t, Lanes> passes{};
+    std::array<bool, Lanes> done{};
+
+    for (std::size_t i = 0; i < numTiles; i++)
+    {
+        const auto colour = state.belongsTo(Tile(static_cast<std::uint16_t>(i)));
+        if (colour == Colour::None)
+            continue;
+
+        auto& stones = colour == Colour::Black ? black : white;
+        const auto bit = bitOf(i);
+        for (std::size_t l = 0; l < Lanes; l++)
+        {
+            if (bit < 64)
+                stones.lo[l] |= std::uint64_t{1} << bit;
+            else
+                stones.hi[l] |= std::uint64_t{1} << (bit - 64);
+        }
+    }
+
+    passes.fill(state.numPasses());
+    done.fill(state.isGameOver());
+
+    // simple ko allows cycles, so games are cut off eventually
+    const auto maxPlies = 3 * numTiles;
+    auto toMove = board.sideToMove();
+    auto numDone = done[0] ? Lanes : 0;
+
+    for (std::size_t ply = 0; ply < maxPlies && numDone < Lanes; ply++)
+    {
+        auto& own = toMove == Colour::Black ? black : white;
+        auto& opp = toMove == Colour::Black ? white : black;
+
+        // Step 1: Find the empty points that are not our own eyes.
+        LaneBits candidates{};
+        for (std::size_t l = 0; l < Lanes; l++)
+        {
+            const auto lo = own.lo[l];
+            const auto hi = own.hi[l];
+            const auto oLo = opp.lo[l];
+            const auto oHi = opp.hi[l];
+
+            // every neighbour is our own stone or off the board
+            const auto northLo = (lo >> stride) | (hi << (64 - stride)) | edges[0].lo;
+            const auto northHi = (hi >> stride) | edges[0].hi;
+            const auto southLo = (lo << stride) | edges[1].lo;
+            const auto southHi = (hi << stride) | (lo >> (64 - stride)) | edges[1].hi;
+            const auto eastLo = (lo >> 1) | (hi << 63) | edges[2].lo;
+            const auto eastHi = (hi >> 1) | edges[2].hi;
+            const auto westLo = (lo << 1) | edges[3].lo;
+            const auto westHi = (hi << 1) | (lo >> 63) | edges[3].hi;
+            const auto surroundedLo = northLo & southLo & eastLo & westLo;
+            const auto surroundedHi = northHi & southHi & eastHi & westHi;
+
+            // enemy stones on the diagonals
+            const auto neLo = (oLo >> (stride + 1)) | (oHi << (63 - stride));
+            const auto neHi = oHi >> (stride + 1);
+            const auto nwLo = (oLo >> (stride - 1)) | (oHi << (65 - stride));
+            const auto nwHi = oHi >> (stride - 1);
+            const auto seLo = oLo << (stride - 1);
+            const auto seHi = (oHi << (stride - 1)) | (oLo >> (65 - stride));
+            const auto swLo = oLo << (stride + 1);
+            const auto swHi = (oHi << (stride + 1)) | (oLo >> (63 - stride));
+
+            const auto anyLo = neLo | nwLo | seLo | swLo;
+            const auto anyHi = neHi | nwHi | seHi | swHi;
+            const auto twoLo = (neLo & (nwLo | seLo | swLo)) | (nwLo & (seLo | swLo)) | (seLo & swLo);
+            const auto twoHi = (neHi & (nwHi | seHi | swHi)) | (nwHi & (seHi | swHi)) | (seHi & swHi);
+
+            // an eye on the edge tolerates no enemy diagonal, elsewhere one
+            const auto spoiltLo = (anyEdge.lo & anyLo) | (~anyEdge.lo & twoLo);
+            const auto spoiltHi = (anyEdge.hi & anyHi) | (~anyEdge.hi & twoHi);
+
+            const auto emptyLo = onBoard.lo & ~(lo | oLo);
+            const auto emptyHi = onBoard.hi & ~(hi | oHi);
+
+            candidates.lo[l] = emptyLo & ~ko.lo[l] & ~(surroundedLo & ~spoiltLo);
+            candidates.hi[l] = emptyHi & ~ko.hi[l] & ~(surroundedHi & ~spoiltHi);
+        }
+
+        // Step 2: Play a random candidate in every lane, trying again in
+        // the lanes where it turned out to be suicide.
+        auto pending = done;
+        for (auto& flag : pending)
+            flag = !flag;
+
+        for (auto numPending = Lanes - numDone; numPending > 0;)
+        {
+            LaneBits moves{};
+            for (std::size_t l = 0; l < Lanes; l++)
+            {
+                if (!pending[l])
+                    continue;
+
+                if (!candidates.empty(l))
+                {
+                    const auto [lo, hi] = pickBit(candidates, l, random);
+                    moves.lo[l] = lo;
+                    moves.hi[l] = hi;
+                    continue;
+                }
+
+                // nothing left to play, so pass
+                pending[l] = false;
+                numPending--;
+                ko.lo[l] = ko.hi[l] = 0;
+                passes[l]++;
+                if (passes[l] >= 2)
+                {
+                    done[l] = true;
+                    numDone++;
+                }
+            }
+
+            if (numPending == 0)
+                break;
+
+            LaneBits placed{};
+            LaneBits empty{};
+            for (std::size_t l = 0; l < Lanes; l++)
+            {
+                placed.lo[l] = own.lo[l] | moves.lo[l];
+                placed.hi[l] = own.hi[l] | moves.hi[l];
+                empty.lo[l] = onBoard.lo & ~(placed.lo[l] | opp.lo[l]);
+                empty.hi[l] = onBoard.hi & ~(placed.hi[l] | opp.hi[l]);
+            }
+
+            // enemy groups without a liberty are captured
+            const auto oppAlive = fill(dilate(empty, stride), opp, stride);
+            for (std::size_t l = 0; l < Lanes; l++)
+            {
+                empty.lo[l] |= opp.lo[l] & ~oppAlive.lo[l];
+                empty.hi[l] |= opp.hi[l] & ~oppAlive.hi[l];
+            }
+
+            const auto ownAlive = fill(dilate(empty, stride), placed, stride);
+            const auto around = dilate(moves, stride);
+
+            for (std::size_t l = 0; l < Lanes; l++)
+            {
+                if (!pending[l])
+                    continue;
+
+                // suicide, so rule the point out
+                if (((placed.lo[l] & ~ownAlive.lo[l]) | (placed.hi[l] & ~ownAlive.hi[l])) != 0)
+                {
+                    candidates.lo[l] &= ~moves.lo[l];
+                    candidates.hi[l] &= ~moves.hi[l];
+                    continue;
+                }
+
+                const auto capturedLo = opp.lo[l] & ~oppAlive.lo[l];
+                const auto capturedHi = opp.hi[l] & ~oppAlive.hi[l];
+
+                // a lone stone that took a lone stone and has only that
+                // point as a liberty can't be retaken straight away
+                const auto adjLo = around.lo[l] & ~moves.lo[l] & onBoard.lo;
+                const auto adjHi = around.hi[l] & ~moves.hi[l] & onBoard.hi;
+                const auto isKo = popCount(capturedLo) + popCount(capturedHi) == 1
+                    && ((adjLo & own.lo[l]) | (adjHi & own.hi[l])) == 0
+                    && popCount(adjLo & empty.lo[l]) + popCount(adjHi & empty.hi[l]) == 1;
+
+                ko.lo[l] = isKo ? capturedLo : 0;
+                ko.hi[l] = isKo ? capturedHi : 0;
+
+                own.lo[l] = placed.lo[l];
+                own.hi[l] = placed.hi[l];
+                opp.lo[l] = oppAlive.lo[l];
+                opp.hi[l] = oppAlive.hi[l];
+                passes[l] = 0;
+                pending[l] = false;
+                numPending--;
+                board.nodes++;
+            }
+        }
+
+        toMove = flipColour(toMove);
+    }
+
+    // Step 3: Score every lane, empty regions counting for the only
+    // colour that reaches them.
+    LaneBits empty{};
+    for (std::size_t l = 0; l < Lanes; l++)
+    {
+        empty.lo[l] = onBoard.lo & ~(black.lo[l] | white.lo[l]);
+        empty.hi[l] = onBoard.hi & ~(black.hi[l] | white.hi[l]);
+    }
+
+    const auto reachBlack = fill(dilate(black, stride), empty, stride);
+    const auto reachWhite = fill(dilate(white, stride), empty, stride);
+
+    LaneBits ownedBlack{};
+    LaneBits ownedWhite{};
+    for (std::size_t l = 0; l < Lanes; l++)
+    {
+        ownedBlack.lo[l] = black.lo[l] | (reachBlack.lo[l] & ~reachWhite.lo[l]);
+        ownedBlack.hi[l] = black.hi[l] | (reachBlack.hi[l] & ~reachWhite.hi[l]);
+        ownedWhite.lo[l] = white.lo[l] | (reachWhite.lo[l] & ~reachBlack.lo[l]);
+        ownedWhite.hi[l] = white.hi[l] | (reachWhite.hi[l] & ~reachBlack.hi[l]);
+    }
+
+    std::uint32_t wins = 0;
+    for (std::size_t l = 0; l < Lanes; l++)
+    {
+        const auto score = static_cast<float>(popCount(ownedBlack, l) - popCount(ownedWhite, l)) - board.getKomi();
+        const auto blackWins = score > 0;
+        wins += blackWins == (board.sideToMove() == Colour::Black);
+    }
+
+    if (ownership != nullptr)
+    {
+        auto& owned = *ownership;
+        for (std::size_t i = 0; i < numTiles; i++)
+        {
+            const auto bit = bitOf(i);
+            const auto word = bit < 64 ? 0 : 1;
+            const auto mask = std::uint64_t{1} << (bit - 64 * word);
+
+            for (std::size_t l = 0; l < Lanes; l++)
+            {
+                const auto black = ((word ? ownedBlack.hi[l] : ownedBlack.lo[l]) & mask) != 0;
+                const auto white = ((word ? ownedWhite.hi[l] : ownedWhite.lo[l]) & mask) != 0;
+                owned[i] += static_cast<std::int32_t>(black) - static_cast<std::int32_t>(white);
+            }
+        }
+    }
+
+    return wins;
+}
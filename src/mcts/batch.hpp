@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "../state/board.hpp"
+
+// Plays out one position several times at once. Each lane holds its own
+// game as a pair of bitboards, with `size + 1` bits to a row so that shifts
+// never wrap onto the next row, and the lanes are stored side by side. A
+// step moves every unfinished lane once, working out captures, liberties
+// and eyes for all of them in the same loops over lanes, which the compiler
+// turns into vector code.
+class BatchPlayout
+{
+    public:
+        static constexpr std::size_t Lanes = 8;
+
+        // rows of 11 bits must fit in 128
+        [[nodiscard]] static constexpr bool supports(std::uint16_t size) { return size >= 2 && size <= 10; }
+
+        explicit BatchPlayout(std::uint16_t size);
+
+        // Plays `Lanes` random games on from `board`, with the same move
+        // choice as Mcts::simulate but only simple ko, and returns how many
+        // the side to move wins. Moves played are counted in `board.nodes`
+        // and, if given, final owners are added to `ownership`.
+        std::uint32_t run(Board& board, std::uint64_t& random, std::vector<std::int32_t>* ownership = nullptr);
+
+        [[nodiscard]] auto size() const { return boardSize; }
+
+    private:
+        struct Mask
+        {
+            std::uint64_t lo = 0;
+            std::uint64_t hi = 0;
+        };
+
+        [[nodiscard]] int bitOf(std::size_t idx) const { return static_cast<int>(idx / boardSize) * stride + static_cast<int>(idx % boardSize); }
+
+        std::uint16_t boardSize;
+        int stride;
+        Mask onBoard{};
+        // points with no neighbour to the north, south, east and west
+        std::array<Mask, 4> edges{};
+        Mask anyEdge{};
+};
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "book.hpp"
+#include "mcts.hpp"
+
+namespace {
+    constexpr char BookMagic[8] = {'G', 'O', 'T', 'B', 'O', 'O', 'K', '2'};
+    constexpr std::size_t HeaderSize = 16;
+
+    constexpr auto BookSeed = UINT64_C(2078630127);
+
+    struct Builder
+    {
+        std::uint16_t plies;
+        std::int32_t rollouts;
+        std::uint16_t width;
+        std::vector<BookRecord> records{};
+        std::unordered_set<std::uint64_t> seen{};
+
+        void visit(const Board& board)
+        {
+            std::uint8_t sym = 0;
+            const auto key = OpeningBook::keyFor(board, sym);
+
+            if (!seen.insert(key.key()).second)
+                return;
+
+            Mcts searcher{};
+            searcher.logging = false;
+            searcher.board = board;
+            searcher.timer = Timer::unlimited();
+            searcher.setNodes(rollouts);
+            searcher.setSeed(BookSeed);
+            searcher.search();
+
+            const auto moves = searcher.rootMoves();
+            if (moves.empty())
+                return;
+
+            const auto& best = moves.front();
+            const auto canonicalMove = symmetric(best.move, sym, board.size());
+            records.push_back(BookRecord{
+                key.high(), key.key(), canonicalMove.index(), 0, best.visits, best.winrate, 0
+            });
+
+            std::cout << "book " << records.size() << " ply " << board.plies() << std::endl;
+
+            if (board.plies() + 1 >= plies)
+                return;
+
+            for (std::size_t i = 0; i < moves.size() && i < width; i++)
+            {
+                auto child = board;
+                if (child.tryMakeMove(moves[i].move))
+                    visit(child);
+            }
+        }
+    };
+}
+
+OpeningBook::OpeningBook(const std::string& path) : file(path)
+{
+    if (file.size() < HeaderSize || std::memcmp(file.data(), BookMagic, 8) != 0)
+        throw std::runtime_error("not a book file");
+
+    std::uint64_t stored = 0;
+    std::memcpy(&stored, file.data() + 8, sizeof(stored));
+
+    const auto body = file.size() - HeaderSize;
+    if (body % sizeof(BookRecord) != 0 || body / sizeof(BookRecord) != stored)
+        throw std::runtime_error("truncated book file");
+
+    records = reinterpret_cast<const BookRecord*>(file.data() + HeaderSize);
+    count = stored;
+}
+
+Zobrist OpeningBook::keyFor(const Board& board, std::uint8_t& sym)
+{
+    auto [key, bestSym] = board.board.canonicalHash();
+    sym = bestSym;
+    key ^= Zobrist::forSize(board.size());
+
+    if (board.sideToMove() == Colour::White)
+        key ^= Zobrist::whiteToMove();
+
+    return key;
+}
+
+std::optional<BookHit> OpeningBook::probe(const Board& board) const
+{
+    std::uint8_t sym = 0;
+    const auto key = keyFor(board, sym);
+
+    const auto end = records + count;
+    const auto found = std::lower_bound(records, end, key, [](const BookRecord& rec, Zobrist target) {
+        return Zobrist(rec.high, rec.low) < target;
+    });
+
+    if (found == end || !(Zobrist(found->high, found->low) == key))
+        return std::nullopt;
+
+    const auto move = symmetric(Tile(found->move), inverseSymmetry(sym), board.size());
+    return BookHit{move, found->visits, found->winrate};
+}
+
+std::size_t buildBook(const std::string& path, std::uint16_t size, float komi,
+                      std::uint16_t plies, std::int32_t rollouts, std::uint16_t width)
+{
+    auto board = Board(size);
+    board.setKomi(komi);
+
+    Builder builder{plies, rollouts, width};
+    builder.visit(board);
+
+    auto& records = builder.records;
+    std::sort(records.begin(), records.end(), [](const BookRecord& a, const BookRecord& b) {
+        return Zobrist(a.high, a.low) < Zobrist(b.high, b.low);
+    });
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+
+    const std::uint64_t stored = records.size();
+    out.write(BookMagic, 8);
+    out.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+    out.write(reinterpret_cast<const char*>(records.data()),
+              static_cast<std::streamsize>(records.size() * sizeof(BookRecord)));
+
+    return records.size();
+}
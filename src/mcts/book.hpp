@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "../io/mapped.hpp"
+#include "../state/board.hpp"
+
+// One entry of a book file. The file is a 16 byte header ("GOTBOOK2" and
+// the record count) followed by records sorted by hash, where the hash is
+// the canonical hash of the position with the side to move and board size
+// folded in, and the move is given in the canonical orientation.
+struct BookRecord
+{
+    std::uint64_t high;
+    std::uint64_t low;
+    std::uint16_t move;
+    std::uint16_t reserved;
+    std::uint32_t visits;
+    float winrate;
+    std::uint32_t padding;
+};
+
+static_assert(sizeof(BookRecord) == 32);
+
+struct BookHit
+{
+    Tile move;
+    std::uint32_t visits;
+    float winrate;
+};
+
+class OpeningBook
+{
+    public:
+        explicit OpeningBook(const std::string& path);
+
+        // The book move for the current position, mapped back to the
+        // orientation of `board`. Legality is left to the caller.
+        [[nodiscard]] std::optional<BookHit> probe(const Board& board) const;
+
+        [[nodiscard]] std::size_t size() const { return count; }
+
+        static Zobrist keyFor(const Board& board, std::uint8_t& sym);
+
+    private:
+        MappedFile file;
+        const BookRecord* records = nullptr;
+        std::size_t count = 0;
+};
+
+// Searches every position reachable by following the `width` most visited
+// moves for `plies` moves from the empty board, and writes the results as
+// a book to `path`.
+std::size_t buildBook(const std::string& path, std::uint16_t size, float komi,
+                      std::uint16_t plies, std::int32_t rollouts, std::uint16_t width);
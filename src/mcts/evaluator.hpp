@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../state/board.hpp"
+
+// Scores leaf positions in batches, as a replacement for (or blended with)
+// random rollouts. Positions are gathered one at a time during selection,
+// and scored together once the batch is full.
+class Evaluator
+{
+    public:
+        virtual ~Evaluator() = default;
+
+        [[nodiscard]] virtual bool supports(std::uint16_t size) const = 0;
+
+        // Adds the current position of `board` to the batch.
+        virtual void gather(const Board& board) = 0;
+
+        // Writes the chance the side to move wins, in [0, 1], for each
+        // gathered position in order, and empties the batch.
+        virtual void evaluate(std::vector<float>& values) = 0;
+};
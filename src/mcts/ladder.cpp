@@ -0,0 +1,145 @@
+#include "ladder.hpp"
+
+namespace {
+    // up to `limit` liberties of the group at `stone`
+    std::uint16_t groupLiberties(const BoardState& state, Tile stone, std::array<Tile, 3>& found, std::uint16_t limit = 3)
+    {
+        std::uint16_t count = 0;
+        const auto size = state.width();
+
+        for (auto tile = state.stonesOf(stone).first; !tile.isNull(); tile = state[tile].next)
+        {
+            const auto dirs = Vec4::getAdjacent(tile, size);
+            for (auto i = 0; i < dirs.length; i++)
+            {
+                const auto adjTile = dirs.elements[i];
+                if (state.belongsTo(adjTile) != Colour::None)
+                    continue;
+
+                auto seen = false;
+                for (std::uint16_t j = 0; j < count; j++)
+                    seen |= found[j] == adjTile;
+
+                if (!seen)
+                {
+                    found[count++] = adjTile;
+                    if (count >= limit)
+                        return count;
+                }
+            }
+        }
+
+        return count;
+    }
+
+    // whether the group at `stone` touches an enemy group in atari
+    bool touchesAtari(const BoardState& state, Tile stone)
+    {
+        const auto colour = state.belongsTo(stone);
+        const auto size = state.width();
+        std::array<Tile, 3> found{};
+
+        for (auto tile = state.stonesOf(stone).first; !tile.isNull(); tile = state[tile].next)
+        {
+            const auto dirs = Vec4::getAdjacent(tile, size);
+            for (auto i = 0; i < dirs.length; i++)
+            {
+                const auto adjTile = dirs.elements[i];
+                const auto owner = state.belongsTo(adjTile);
+                if (owner == Colour::None || owner == colour)
+                    continue;
+
+                // The board counts a liberty once per stone it touches, so
+                // a lone liberty shows as up to 4 and only those are counted.
+                const auto pseudo = state.liberties(adjTile);
+                if (pseudo == 1 || (pseudo <= 4 && groupLiberties(state, adjTile, found, 2) == 1))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    // tells apart the two questions asked about the same group
+    constexpr auto AttackerToMove = Zobrist(UINT64_C(0x2545F4914F6CDD1D), UINT64_C(0x9FB21C651E98DF25));
+}
+
+LadderReader::LadderReader(std::uint8_t tableBits)
+{
+    table = std::vector<Entry>(std::size_t{1} << tableBits);
+    mask = (std::uint64_t{1} << tableBits) - 1;
+}
+
+bool LadderReader::captured(const BoardState& state, Tile stone)
+{
+    return defenderLoses(state, stone, 0);
+}
+
+bool LadderReader::canCapture(const BoardState& state, Tile stone)
+{
+    return attackerWins(state, stone, 0);
+}
+
+bool LadderReader::defenderLoses(const BoardState& state, Tile stone, std::uint16_t depth)
+{
+    auto hash = state.getHash();
+    hash ^= state.groupHash(stone);
+
+    auto& entry = table[hash.key() & mask];
+    if (entry.hash == hash)
+        return entry.result;
+
+    std::array<Tile, 3> libs{};
+    auto result = false;
+
+    // taking a chasing stone breaks the ladder, as does running out of depth
+    if (depth < MaxDepth && groupLiberties(state, stone, libs) == 1 && !touchesAtari(state, stone))
+    {
+        auto next = state;
+        const auto colour = state.belongsTo(stone);
+
+        if (next.placeStone(libs[0], colour))
+            result = true;
+        else
+        {
+            const auto count = groupLiberties(next, stone, libs);
+            result = count <= 1 || (count == 2 && attackerWins(next, stone, depth + 1));
+        }
+    }
+
+    entry = Entry{hash, result};
+    return result;
+}
+
+bool LadderReader::attackerWins(const BoardState& state, Tile stone, std::uint16_t depth)
+{
+    auto hash = state.getHash();
+    hash ^= state.groupHash(stone);
+    hash ^= AttackerToMove;
+
+    auto& entry = table[hash.key() & mask];
+    if (entry.hash == hash)
+        return entry.result;
+
+    std::array<Tile, 3> libs{};
+    auto result = false;
+
+    if (depth < MaxDepth && groupLiberties(state, stone, libs) == 2)
+    {
+        const auto attacker = flipColour(state.belongsTo(stone));
+
+        // atari from either side
+        for (auto i = 0; i < 2 && !result; i++)
+        {
+            auto next = state;
+            if (next.placeStone(libs[i], attacker))
+                continue;
+
+            std::array<Tile, 3> after{};
+            result = groupLiberties(next, stone, after) == 1 && defenderLoses(next, stone, depth + 1);
+        }
+    }
+
+    entry = Entry{hash, result};
+    return result;
+}
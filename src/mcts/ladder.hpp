@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../state/board.hpp"
+
+// Reads ladders on copies of a `BoardState`, so the game history is never
+// touched. Every answer is cached under the position hash and the hash of
+// the chased group, making repeated questions about the same ladder, from
+// the tree or from playouts, a single table probe.
+class LadderReader
+{
+    public:
+        explicit LadderReader(std::uint8_t tableBits = 16);
+
+        // Whether the group at `stone`, in atari with its owner to move,
+        // is captured in a ladder however it runs.
+        bool captured(const BoardState& state, Tile stone);
+
+        // Whether the group at `stone`, with two liberties and the other
+        // side to move, can be captured in a ladder.
+        bool canCapture(const BoardState& state, Tile stone);
+
+    private:
+        static constexpr std::uint16_t MaxDepth = 80;
+
+        struct Entry
+        {
+            Zobrist hash{};
+            bool result = false;
+        };
+
+        bool defenderLoses(const BoardState& state, Tile stone, std::uint16_t depth);
+
+        bool attackerWins(const BoardState& state, Tile stone, std::uint16_t depth);
+
+        std::vector<Entry> table{};
+        std::uint64_t mask{};
+};
@@ -1,11 +1,33 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <thread>
 
 #include "mcts.hpp"
 
+namespace {
+    constexpr auto valueOf(State state)
+    {
+        return state == State::Win ? 1.0F : state == State::Loss ? 0.0F : 0.5F;
+    }
+
+    // splitmix64 finaliser, so neighbouring threads get unrelated streams
+    std::uint64_t seedFor(std::uint64_t hash, std::uint64_t index)
+    {
+        auto seed = hash + UINT64_C(0x9E3779B97F4A7C15) * (index + 1);
+        seed = (seed ^ (seed >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+        seed = (seed ^ (seed >> 27)) * UINT64_C(0x94D049BB133111EB);
+        seed ^= seed >> 31;
+
+        // xorshift never leaves zero
+        return seed ? seed : 1;
+    }
+}
+
 Tile Mcts::search()
 {
+    const auto trace = TraceScope("search");
     const auto allocatedTime = timer.alloc();
     auto elapsed = 0;
     auto rollouts = 0;
@@ -16,36 +38,40 @@ Tile Mcts::search()
 
     timer.start();
 
-    tree.clear(board);
-
-    for (rollouts = 1; rollouts <= maxNodes; rollouts++)
+    if (const auto bookMove = probeBook())
     {
-        // Stage 1: Select a lead node already in the search tree.
-        const auto selectedNode = selectLeaf();
+        timer.stop(bookMove->isNull());
+        return *bookMove;
+    }
 
-        // Stage 2: If not a terminal node, pick a child of the leaf
-        // node that isn't currently in the tree.
-        if (selectedNode != -1)
-            expandNode(selectedNode);
+    startSearch();
 
-        // Stage 3: Randomly simulate the outcome of the game from there.
-        const auto result = simulate();
+    for (rollouts = 1; rollouts <= maxNodes; rollouts++)
+    {
+        // The result from the root is already known, no need to search on.
+        if (tree[0].isProven())
+            break;
 
-        // Stage 4: Backpropogate the result towards the root.
-        backprop(result);
+        iterate();
 
         elapsed = timer.elapsed();
-        if (elapsed >= allocatedTime)
+        if (!deterministic && elapsed >= allocatedTime)
+        {
+            traceInstant("timer expired", elapsed);
             break;
+        }
     }
 
+    finishSearch(std::min(rollouts, maxNodes), elapsed);
+
     const auto& rootNode = tree[0];
     auto bestIdx = 0;
     auto bestScore = 0.0;
+    auto bestRank = 0.0;
 
     for (std::uint32_t i = 0; i < rootNode.numChildren(); i++)
     {
-        const auto move = rootNode[i];
+        const auto move = tree.edge(rootNode, i);
 
         // unexplored move
         if (move.ptr == -1)
@@ -56,7 +82,11 @@ Tile Mcts::search()
         const auto visits = static_cast<double>(node.visits);
         const auto wins = static_cast<double>(node.wins);
 
-        const auto score = wins / visits;
+        auto score = wins / visits;
+
+        // proven children override their sampled score
+        if (node.isProven())
+            score = node.state == State::Loss ? 1.0 : 0.0;
 
         if (logging)
         {
@@ -64,14 +94,17 @@ Tile Mcts::search()
             std::cout << " score " << 100.0 * score << "% (" << node.wins << "/" << node.visits << ")" << std::endl;
         }
 
-        if (score > bestScore)
+        // a proven win outranks any sampled score, even one of 100%
+        const auto rank = node.state == State::Loss ? 2.0 : score;
+        if (rank > bestRank)
         {
+            bestRank = rank;
             bestScore = score;
             bestIdx = i;
         }
     }
 
-    const auto bestMove = rootNode[bestIdx].move;
+    const auto bestMove = tree.edge(rootNode, bestIdx).move;
 
     if (logging)
     {
@@ -79,6 +112,8 @@ Tile Mcts::search()
         std::cout << " nodes " << board.nodes;
         std::cout << " rollouts " << rollouts;
         std::cout << " score " << 100.0 * bestScore << "%";
+        if (rootNode.isProven())
+            std::cout << " proven " << (rootNode.state == State::Win ? "win" : "loss");
         std::cout << " pv " << tileToString(bestMove, board.size()) << std::endl;
     }
 
@@ -87,14 +122,313 @@ Tile Mcts::search()
     return bestMove;
 }
 
-double Mcts::getUct(const Node& node, std::uint32_t childIdx)
+void Mcts::startSearch()
 {
-    if (node.visits < 4)
-        return 100.0;
+    // carry on from the previous (or a loaded) tree if it is for this
+    // position, and the game so far leaves all of its first moves legal
+    if (deterministic || !tree.rootedAt(board) || !tree.playableFrom(board, 1))
+        tree.clear(board, &ladders);
+
+    const auto positionHash = board.key().key();
+    if (deterministic)
+        random = seedFor(positionHash, 0);
+
+    // replies are kept between searches, unless the points they name change
+    if (deterministic || replySize != board.size())
+    {
+        for (auto& table : replies)
+            table.fill(Tile{});
+        replySize = board.size();
+    }
+
+    // ownership is kept for as long as the tree is
+    if (tree.size() == 1 || owned.size() != static_cast<std::size_t>(board.board.sizeOf()))
+    {
+        owned.assign(board.board.sizeOf(), 0);
+        ownedSamples = 0;
+    }
+
+    evalActive = evaluator && evalWeight > 0.0F && evaluator->supports(board.size());
+
+    if (!batchPlayouts || !BatchPlayout::supports(board.size()))
+        batch.reset();
+    else if (!batch || batch->size() != board.size())
+        batch.emplace(board.size());
+
+    if (leafThreads <= 1 || !leafPool || batch)
+        leafWorkers.clear();
+    else if (leafWorkers.size() != leafThreads)
+    {
+        leafWorkers.clear();
+        leafResults.assign(leafThreads, 0.0F);
+
+        for (std::size_t i = 0; i < leafThreads; i++)
+        {
+            auto worker = std::make_unique<Mcts>();
+            worker->logging = false;
+            worker->random = random ^ (UINT64_C(0x9E3779B97F4A7C15) * (i + 1));
+            leafWorkers.push_back(std::move(worker));
+        }
+    }
+
+    for (std::size_t i = 0; i < leafWorkers.size(); i++)
+    {
+        auto& worker = leafWorkers[i];
+        if (deterministic)
+            worker->random = seedFor(positionHash, i + 1);
+
+        if (deterministic || worker->replySize != replySize)
+        {
+            worker->replies = replies;
+            worker->replySize = replySize;
+        }
+
+        worker->owned.assign(owned.size(), 0);
+        worker->ownedSamples = 0;
+    }
+
+    stats.reset();
+    stats.allocations = heapAllocations();
+}
+
+void Mcts::iterate()
+{
+    // Stage 1: Select a lead node already in the search tree.
+    std::int32_t selectedNode;
+    {
+        const auto phase = PhaseTimer(stats, Phase::Select);
+        const auto trace = TraceScope("selectLeaf");
+        selectedNode = selectLeaf();
+    }
+
+    // Stage 2: If not a terminal node, pick a child of the leaf
+    // node that isn't currently in the tree.
+    if (selectedNode != -1)
+    {
+        const auto phase = PhaseTimer(stats, Phase::Expand);
+        const auto trace = TraceScope("expandNode");
+        expandNode(selectedNode);
+    }
+
+    if constexpr (TrackStats)
+        stats.depth += selectionLine.size();
+
+    // terminal leaves are backed up straight away with their exact result
+    const auto useEvaluator = evalActive && board.gameState() == State::Ongoing;
+
+    // Stage 3: Randomly simulate the outcome of the game from there.
+    auto result = 0.5F;
+    if (!useEvaluator || evalWeight < 1.0F)
+    {
+        const auto phase = PhaseTimer(stats, Phase::Simulate);
+        const auto trace = TraceScope("simulate");
+        if (batch)
+        {
+            const auto wins = batch->run(board, random, &owned);
+            ownedSamples += BatchPlayout::Lanes;
+            result = static_cast<float>(wins) / BatchPlayout::Lanes;
+        }
+        else if (!leafWorkers.empty())
+            result = leafRollouts();
+        else
+            result = valueOf(simulate());
+    }
+
+    // Stage 4: Backpropogate the result towards the root, or hold it
+    // until the leaf has been scored along with the rest of its batch.
+    if (useEvaluator)
+    {
+        const auto phase = PhaseTimer(stats, Phase::Evaluate);
+        deferLeaf(result);
+        if (pending.size() >= evalBatch)
+            flushLeaves();
+    }
+    else
+    {
+        const auto phase = PhaseTimer(stats, Phase::Backprop);
+        const auto trace = TraceScope("backprop");
+        backprop(result);
+    }
+}
+
+void Mcts::finishSearch(std::int32_t rollouts, std::int64_t elapsed)
+{
+    if (!pending.empty())
+    {
+        const auto phase = PhaseTimer(stats, Phase::Evaluate);
+        flushLeaves();
+    }
+
+    stats.rollouts = rollouts;
+    stats.nodes = board.nodes;
+    stats.treeSize = tree.size();
+    stats.time = elapsed;
+    stats.allocations = heapAllocations() - stats.allocations;
+}
+
+void Mcts::analyse(std::int64_t interval, const std::function<void(const std::string&)>& report)
+{
+    auto elapsed = std::int64_t{0};
+    auto rollouts = 0;
+    auto nextReport = interval;
+    board.nodes = 0;
+
+    auto clock = Timer();
+    clock.start();
+
+    startSearch();
+
+    while (!stopRequested)
+    {
+        // keep reporting a proven root until told to stop
+        if (tree[0].isProven())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        else
+        {
+            iterate();
+            rollouts++;
+        }
+
+        elapsed = clock.elapsed();
+        if (elapsed >= nextReport)
+        {
+            if (!pending.empty())
+                flushLeaves();
+
+            report(analysisInfo());
+            nextReport = elapsed + interval;
+        }
+    }
+
+    finishSearch(rollouts, elapsed);
+    stopRequested = false;
+}
+
+std::string Mcts::analysisInfo()
+{
+    std::string info{};
+
+    const auto moves = rootMoves();
+    for (std::size_t i = 0; i < moves.size(); i++)
+    {
+        const auto& rootMove = moves[i];
+        const auto winrate = static_cast<int>(10000.0F * rootMove.winrate);
+
+        info += "info move " + tileToString(rootMove.move, board.size());
+        info += " visits " + std::to_string(rootMove.visits);
+        info += " winrate " + std::to_string(winrate);
+        info += " order " + std::to_string(i);
+        info += " pv " + tileToString(rootMove.move, board.size());
+
+        std::int32_t nodePtr = -1;
+        const auto& rootNode = tree[0];
+        for (std::uint32_t j = 0; j < rootNode.numExplored(); j++)
+            if (tree.edge(rootNode, j).move == rootMove.move)
+                nodePtr = tree.edge(rootNode, j).ptr;
+
+        // then follow the most visited child down
+        for (auto depth = 1; depth < MaxPvLength && nodePtr != -1; depth++)
+        {
+            const auto& node = tree[nodePtr];
+            std::int32_t best = -1;
+            auto bestMove = Tile{};
+
+            for (std::uint32_t j = 0; j < node.numExplored(); j++)
+            {
+                const auto& edge = tree.edge(node, j);
+                if (best == -1 || tree[edge.ptr].visits > tree[best].visits)
+                {
+                    best = edge.ptr;
+                    bestMove = edge.move;
+                }
+            }
+
+            if (best != -1)
+                info += " " + tileToString(bestMove, board.size());
+
+            nodePtr = best;
+        }
+
+        info += "\n";
+    }
+
+    return info;
+}
+
+std::vector<float> Mcts::ownership() const
+{
+    auto shares = std::vector<float>(owned.size(), 0.0F);
+
+    if (ownedSamples > 0)
+        for (std::size_t i = 0; i < owned.size(); i++)
+            shares[i] = static_cast<float>(owned[i]) / static_cast<float>(ownedSamples);
+
+    return shares;
+}
+
+void Mcts::sampleOwnership(std::int32_t rollouts, std::int64_t ms)
+{
+    auto clock = Timer();
+    clock.start();
+    board.nodes = 0;
+
+    startSearch();
+
+    auto done = 0;
+    while (done < rollouts && clock.elapsed() < ms && !tree[0].isProven())
+    {
+        iterate();
+        done++;
+    }
+
+    finishSearch(done, clock.elapsed());
+}
+
+std::vector<RootMove> Mcts::rootMoves()
+{
+    std::vector<RootMove> moves{};
+
+    const auto& rootNode = tree[0];
+    for (std::uint32_t i = 0; i < rootNode.numExplored(); i++)
+    {
+        const auto& edge = tree.edge(rootNode, i);
+        const auto& node = tree[edge.ptr];
+        const auto winrate = node.visits ? node.wins / static_cast<float>(node.visits) : 0.0F;
+        moves.push_back(RootMove{edge.move, node.visits, winrate});
+    }
 
+    std::stable_sort(moves.begin(), moves.end(), [](const auto& a, const auto& b) {
+        return a.visits > b.visits;
+    });
+
+    return moves;
+}
+
+std::optional<Tile> Mcts::probeBook()
+{
+    if (!book || board.plies() >= bookPlies)
+        return std::nullopt;
+
+    const auto hit = book->probe(board);
+    if (!hit || !board.tryMakeMove(hit->move))
+        return std::nullopt;
+
+    board.undoMove();
+
+    if (logging)
+    {
+        std::cout << "# info book move " << tileToString(hit->move, board.size());
+        std::cout << " score " << 100.0 * hit->winrate << "% (" << hit->visits << ")" << std::endl;
+    }
+
+    return hit->move;
+}
+
+double Mcts::getUct(const Node& node, std::uint32_t childIdx)
+{
     const auto N = static_cast<double>(node.visits);
 
-    const auto childPtr = node[childIdx].ptr;
+    const auto childPtr = tree.edge(node, childIdx).ptr;
 
     if (childPtr == -1)
         return 100.0;
@@ -130,14 +464,20 @@ std::int32_t Mcts::selectLeaf()
         const auto& node = tree[nodePtr];
 
         // found a terminal node
-        if (node.isTerminal())
+        if (node.isProven())
             return -1;
 
         std::uint32_t bestIdx = 0;
-        double bestUct = 0.0;
+        double bestUct = -1.0;
 
-        for (std::uint32_t i = 0; i < node.numChildren(); i++)
+        // proven children are skipped, they cannot be a proven loss for
+        // the opponent or this node would be proven as well
+        const auto explored = node.numExplored();
+        for (std::uint32_t i = 0; i < explored; i++)
         {
+            if (tree[tree.edge(node, i).ptr].isProven())
+                continue;
+
             const auto uct = getUct(node, i);
             if (uct > bestUct)
             {
@@ -146,13 +486,16 @@ std::int32_t Mcts::selectLeaf()
             }
         }
 
-        const auto next = node[bestIdx].ptr;
-
-        if (next == -1)
+        // expand here if widening has unlocked a child not yet in the
+        // tree, or if every explored child has been proven lost for us
+        if (explored < node.numUnlocked() || bestUct < 0.0)
             break;
 
+        const auto& edge = tree.edge(node, bestIdx);
+        const auto next = edge.ptr;
+
         // verified legal move
-        board.makeMove(node[bestIdx].move);
+        board.makeMove(edge.move);
         selectionLine.push_back(next);
         nodePtr = next;
     }
@@ -165,70 +508,184 @@ void Mcts::expandNode(const std::int32_t nodePtr)
     auto& node = tree[nodePtr];
 
     assert(node.leftToExplore > 0);
-    const auto randomIdx = getRandom() % node.leftToExplore;
+    const auto nextIdx = node.numExplored();
 
     node.leftToExplore--;
 
-    if (node.leftToExplore)
-        std::swap(node[randomIdx], node[node.leftToExplore]);
-
     // verified legal move
-    board.makeMove(node[node.leftToExplore].move);
+    board.makeMove(tree.edge(node, nextIdx).move);
 
     // `node` becomes invalid from here
-    tree.add(Node(board));
+    const auto childPtr = tree.add(board, &ladders);
 
-    auto& nodeToExplore = tree[nodePtr][tree[nodePtr].leftToExplore];
+    auto& nodeToExplore = tree.edge(tree[nodePtr], nextIdx);
 
-    nodeToExplore.ptr = tree.size() - 1;
+    nodeToExplore.ptr = childPtr;
 
     selectionLine.push_back(nodeToExplore.ptr);
 };
 
 State Mcts::simulate()
 {
-    const auto state = board.gameState();
+    const auto state = board.gameState(&owned);
 
     // This is a terminal node, end of rollout.
     if (state != State::Ongoing)
+    {
+        ownedSamples++;
         return state;
+    }
 
     auto moves = std::vector<Tile>(0);
 
     genViable(moves);
 
-    const auto numLegal = moves.size();
-    const auto randIdx = numLegal > 1 ? getRandom() % (numLegal - 1) : 0;
-    const auto randMove = moves[randIdx];
+    // play the last reply to the previous move that won, while it is viable
+    auto& reply = replies[static_cast<std::size_t>(board.sideToMove())][board.lastMove(0).index()];
+    auto move = reply;
+
+    if (move.isNull() || std::find(moves.begin(), moves.end(), move) == moves.end())
+    {
+        const auto numLegal = moves.size();
+        const auto randIdx = numLegal > 1 ? getRandom() % (numLegal - 1) : 0;
+        move = moves[randIdx];
+    }
 
-    board.makeMove(randMove);
+    board.makeMove(move);
 
     const auto result = flipState(simulate());
 
     board.undoMove();
 
+    // remember replies that won, and forget those that lost
+    if (result == State::Win && !move.isNull())
+        reply = move;
+    else if (result != State::Win && reply == move)
+        reply = Tile{};
+
     return result;
 }
 
-void Mcts::backprop(State result)
+float Mcts::leafRollouts()
 {
+    for (auto& worker : leafWorkers)
+    {
+        worker->board = board;
+        worker->board.nodes = 0;
+    }
+
+    leafPool->runAll(leafWorkers.size(), [this](std::size_t i) {
+        const auto trace = TraceScope("leaf rollout");
+        leafResults[i] = valueOf(leafWorkers[i]->simulate());
+    });
+
+    auto total = 0.0F;
+    for (std::size_t i = 0; i < leafWorkers.size(); i++)
+    {
+        auto& worker = *leafWorkers[i];
+        total += leafResults[i];
+        board.nodes += worker.board.nodes;
+
+        for (std::size_t j = 0; j < owned.size(); j++)
+        {
+            owned[j] += worker.owned[j];
+            worker.owned[j] = 0;
+        }
+
+        ownedSamples += worker.ownedSamples;
+        worker.ownedSamples = 0;
+    }
+
+    return total / static_cast<float>(leafWorkers.size());
+}
+
+void Mcts::backprop(float result)
+{
+    auto childState = State::Ongoing;
+
     while (selectionLine.size() > 0)
     {
         const auto nodePtr = selectionLine.back();
         selectionLine.pop_back();
-        result = flipState(result);
+        result = 1.0F - result;
 
         auto& node = tree[nodePtr];
 
         node.visits += 1;
+        node.wins += result;
 
-        if (result == State::Win)
-            node.wins += 1;
+        if (childState != State::Ongoing)
+            prove(node, childState);
+
+        childState = node.state;
 
         board.undoMove();
     }
 
     tree[0].visits += 1;
+
+    if (childState != State::Ongoing)
+        prove(tree[0], childState);
+}
+
+void Mcts::deferLeaf(float rollout)
+{
+    evaluator->gather(board);
+
+    // Visits are counted straight away as a virtual loss, which steers the
+    // following selections away from this line until it has been scored.
+    for (const auto nodePtr : selectionLine)
+    {
+        tree[nodePtr].visits += 1;
+        board.undoMove();
+    }
+
+    tree[0].visits += 1;
+
+    pending.push_back(PendingLeaf{selectionLine, rollout});
+    selectionLine.clear();
+}
+
+void Mcts::flushLeaves()
+{
+    evaluator->evaluate(values);
+
+    for (std::size_t i = 0; i < pending.size(); i++)
+    {
+        const auto& leaf = pending[i];
+        auto result = evalWeight * values[i] + (1.0F - evalWeight) * leaf.rollout;
+
+        for (auto it = leaf.line.rbegin(); it != leaf.line.rend(); it++)
+        {
+            result = 1.0F - result;
+            tree[*it].wins += result;
+        }
+    }
+
+    pending.clear();
+}
+
+void Mcts::prove(Node& node, State childState)
+{
+    if (node.isProven())
+        return;
+
+    // any move into a lost position for the opponent wins
+    if (childState == State::Loss)
+    {
+        node.state = State::Win;
+        return;
+    }
+
+    // otherwise we are lost only once every move has been proven to lose
+    if (node.leftToExplore > 0)
+        return;
+
+    for (std::uint32_t i = 0; i < node.numChildren(); i++)
+        if (tree[tree.edge(node, i).ptr].state != State::Win)
+            return;
+
+    node.state = State::Loss;
 }
 
 void Mcts::genViable(std::vector<Tile>& moves)
@@ -237,11 +694,14 @@ void Mcts::genViable(std::vector<Tile>& moves)
     for (auto move = head.first; !move.isNull(); move = board.board[move].next)
     {
         auto friendlyAdj = 0;
+        auto savesAtari = false;
         const auto dirs = Vec4::getAdjacent(move, board.size());
         for (auto i = 0; i < dirs.length; i++)
         {
             const auto adjTile = dirs.elements[i];
-            friendlyAdj += board.board.belongsTo(adjTile) == board.sideToMove();
+            const auto friendly = board.board.belongsTo(adjTile) == board.sideToMove();
+            friendlyAdj += friendly;
+            savesAtari |= friendly && board.board.liberties(adjTile) == 1;
         }
 
         auto enemyDiag = 0;
@@ -264,7 +724,12 @@ void Mcts::genViable(std::vector<Tile>& moves)
         if (!isLegal)
             continue;
 
-        moves.push_back(move);
+        // and running from atari into a ladder
+        const auto laddered = savesAtari && board.board.liberties(move) == 2
+                           && ladders.canCapture(board.board, move);
+
+        if (!laddered)
+            moves.push_back(move);
 
         board.undoMove();
     }
@@ -1,6 +1,27 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "batch.hpp"
+#include "book.hpp"
+#include "evaluator.hpp"
+#include "ladder.hpp"
+#include "pool.hpp"
+#include "stats.hpp"
 #include "timer.hpp"
 #include "tree.hpp"
 
+struct RootMove
+{
+    Tile move;
+    std::uint32_t visits;
+    float winrate;
+};
+
 class Mcts
 {
     public:
@@ -8,19 +29,118 @@ class Mcts
         Timer timer;
         bool logging = true;
 
+        static constexpr std::int32_t DefaultNodes = 1000000;
+
         Mcts()
         {
             board = Board(3);
             tree = SearchTree(board);
-            maxNodes = 1000000;
+            maxNodes = DefaultNodes;
             timer = Timer(0, 3, 1);
         }
 
         Tile search();
 
+        // Searches the current position until `stop` is called, passing
+        // `report` one line per root move every `interval` ms.
+        void analyse(std::int64_t interval, const std::function<void(const std::string&)>& report);
+
+        void stop() { stopRequested = true; }
+
         void setNodes(std::int32_t nodes) { maxNodes = nodes; }
 
+        void setSeed(std::uint64_t seed) { random = seed; }
+
+        // `weight` is the share of each leaf's value taken from the evaluator
+        // rather than a rollout, 0 disables it and 1 skips rollouts entirely.
+        void setEvaluator(std::shared_ptr<Evaluator> eval, float weight)
+        {
+            evaluator = std::move(eval);
+            evalWeight = weight;
+        }
+
+        void setEvalWeight(float weight) { evalWeight = weight; }
+
+        void setEvalBatch(std::size_t size) { evalBatch = size; }
+
+        // Scores each leaf with BatchPlayout::Lanes lockstep playouts
+        // instead of one, on boards small enough for them.
+        void setBatchPlayouts(bool enabled) { batchPlayouts = enabled; }
+
+        // Scores each leaf with `threads` rollouts run as tasks on `pool`,
+        // backing up their mean, while this thread only walks the tree.
+        // The pool may be shared by many searchers, and its size caps how
+        // many rollouts run at once. Batch playouts take precedence when
+        // they are enabled.
+        void setLeafThreads(std::size_t threads, std::shared_ptr<ThreadPool> pool)
+        {
+            leafThreads = std::max<std::size_t>(threads, 1);
+            leafPool = std::move(pool);
+        }
+
+        // Makes a search depend on nothing but the position, the node budget
+        // and the number of leaf threads. The tree and reply tables start
+        // empty, every random state is seeded from the position hash and its
+        // thread index, and the clock is ignored. Each iteration is an epoch
+        // of one rollout per leaf worker that ends once all have finished, with
+        // results folded in worker order.
+        void setDeterministic(bool enabled) { deterministic = enabled; }
+
+        [[nodiscard]] const auto& lastStats() const { return stats; }
+
+        // explored moves from the root of the last search, most visited first
+        std::vector<RootMove> rootMoves();
+
+        // For each point, the share of rollouts from the current root that
+        // ended with it owned by black, less the share owned by white.
+        std::vector<float> ownership() const;
+
+        // rollouts that the ownership is taken from
+        [[nodiscard]] auto ownershipSamples() const { return ownedSamples; }
+
+        // Adds up to `rollouts` rollouts, for at most `ms` milliseconds, to
+        // the current tree without picking a move, to firm up ownership.
+        void sampleOwnership(std::int32_t rollouts, std::int64_t ms);
+
+        void saveTree(const std::string& path) const { tree.save(path); }
+
+        // Replaces the search tree with the one saved in `path`, as long as
+        // it was built from the current position and its first moves are
+        // legal in this game. Replaying the whole tree would cost about as
+        // much as searching it, so deeper moves are trusted as on reuse.
+        bool loadTree(const std::string& path)
+        {
+            SearchTree loaded{};
+            loaded.load(path);
+
+            if (!loaded.rootedAt(board) || !loaded.playableFrom(board, 1))
+                return false;
+
+            tree = std::move(loaded);
+            owned.clear();
+            return true;
+        }
+
+        // play straight from `openingBook` while fewer than `plies` moves have been made
+        void setBook(std::shared_ptr<const OpeningBook> openingBook, std::size_t plies)
+        {
+            book = std::move(openingBook);
+            bookPlies = plies;
+        }
+
     private:
+        friend class MicroBench;
+
+        static constexpr auto MaxPvLength = 16;
+
+        void startSearch();
+
+        void iterate();
+
+        void finishSearch(std::int32_t rollouts, std::int64_t elapsed);
+
+        std::string analysisInfo();
+
         double getUct(const Node& node, std::uint32_t childIdx);
 
         std::uint64_t getRandom();
@@ -31,12 +151,62 @@ class Mcts
 
         State simulate();
 
-        void backprop(State result);
+        float leafRollouts();
+
+        void backprop(float result);
+
+        void deferLeaf(float rollout);
+
+        void flushLeaves();
+
+        void prove(Node& node, State childState);
 
         void genViable(std::vector<Tile>& moves);
 
+        std::optional<Tile> probeBook();
+
         SearchTree tree;
+        SearchStats stats{};
         std::uint64_t random = UINT64_C(2078630127);
         std::int32_t maxNodes{};
         std::vector<std::int32_t> selectionLine{};
+        LadderReader ladders{};
+
+        // last good reply for each side to each previous move, indexed by
+        // tile with 1024 for a pass or no move at all
+        std::array<std::array<Tile, 1025>, 2> replies{};
+        std::uint16_t replySize = 0;
+
+        // per point ownership summed over the finished rollouts from the root
+        std::vector<std::int32_t> owned{};
+        std::uint32_t ownedSamples = 0;
+
+        struct PendingLeaf
+        {
+            std::vector<std::int32_t> line;
+            float rollout;
+        };
+
+        std::shared_ptr<const OpeningBook> book{};
+        std::size_t bookPlies{};
+
+        std::atomic<bool> stopRequested{false};
+        bool evalActive = false;
+
+        bool batchPlayouts = false;
+        std::optional<BatchPlayout> batch{};
+
+        // each leaf worker only uses its board, random state, reply tables,
+        // ladder cache and ownership counts
+        bool deterministic = false;
+        std::size_t leafThreads = 1;
+        std::shared_ptr<ThreadPool> leafPool{};
+        std::vector<std::unique_ptr<Mcts>> leafWorkers{};
+        std::vector<float> leafResults{};
+
+        std::shared_ptr<Evaluator> evaluator{};
+        float evalWeight = 0.0F;
+        std::size_t evalBatch = 16;
+        std::vector<PendingLeaf> pending{};
+        std::vector<float> values{};
 };
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "network.hpp"
+
+namespace {
+    constexpr std::uint32_t NetworkVersion = 1;
+
+    template <typename T>
+    void readInto(std::ifstream& file, T* dst, std::size_t count)
+    {
+        file.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(count * sizeof(T)));
+        if (!file)
+            throw std::runtime_error("truncated network file");
+    }
+
+    void addColumn(float* acc, const float* column, std::uint32_t length)
+    {
+#if defined(__AVX2__)
+        for (std::uint32_t i = 0; i < length; i += 8)
+        {
+            const auto sum = _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_loadu_ps(column + i));
+            _mm256_storeu_ps(acc + i, sum);
+        }
+#else
+        for (std::uint32_t i = 0; i < length; i++)
+            acc[i] += column[i];
+#endif
+    }
+
+    float reluDot(const float* acc, const float* weights, std::uint32_t length)
+    {
+#if defined(__AVX2__)
+        auto sum = _mm256_setzero_ps();
+        const auto zero = _mm256_setzero_ps();
+        for (std::uint32_t i = 0; i < length; i += 8)
+        {
+            const auto act = _mm256_max_ps(_mm256_loadu_ps(acc + i), zero);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(act, _mm256_loadu_ps(weights + i)));
+        }
+
+        const auto halves = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        const auto pairs = _mm_add_ps(halves, _mm_movehl_ps(halves, halves));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+#else
+        auto sum = 0.0F;
+        for (std::uint32_t i = 0; i < length; i++)
+            sum += std::max(acc[i], 0.0F) * weights[i];
+        return sum;
+#endif
+    }
+}
+
+ValueNetwork::ValueNetwork(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("cannot open network file");
+
+    char magic[4];
+    std::uint32_t header[3];
+    readInto(file, magic, 4);
+    readInto(file, header, 3);
+
+    if (std::memcmp(magic, "GOTN", 4) != 0 || header[0] != NetworkVersion)
+        throw std::runtime_error("not a network file");
+
+    if (header[1] == 0 || header[1] > 25 || header[2] == 0 || header[2] % 8 != 0)
+        throw std::runtime_error("unsupported network shape");
+
+    boardSize = static_cast<std::uint16_t>(header[1]);
+    hiddenSize = header[2];
+
+    const auto inputs = 2 * static_cast<std::size_t>(boardSize) * boardSize;
+    inputWeights.resize(inputs * hiddenSize);
+    hiddenBias.resize(hiddenSize);
+    outputWeights.resize(hiddenSize);
+    hidden.resize(hiddenSize);
+
+    readInto(file, inputWeights.data(), inputWeights.size());
+    readInto(file, hiddenBias.data(), hiddenBias.size());
+    readInto(file, outputWeights.data(), outputWeights.size());
+    readInto(file, &outputBias, 1);
+}
+
+void ValueNetwork::gather(const Board& board)
+{
+    const auto area = static_cast<std::uint16_t>(boardSize * boardSize);
+    const auto stm = board.sideToMove();
+
+    offsets.push_back(static_cast<std::uint32_t>(features.size()));
+
+    for (std::uint16_t i = 0; i < area; i++)
+    {
+        const auto owner = board.board.belongsTo(Tile(i));
+        if (owner != Colour::None)
+            features.push_back(owner == stm ? i : area + i);
+    }
+}
+
+void ValueNetwork::evaluate(std::vector<float>& values)
+{
+    values.clear();
+    offsets.push_back(static_cast<std::uint32_t>(features.size()));
+
+    for (std::size_t i = 0; i + 1 < offsets.size(); i++)
+    {
+        const auto begin = offsets[i];
+        values.push_back(forward(features.data() + begin, offsets[i + 1] - begin));
+    }
+
+    features.clear();
+    offsets.clear();
+}
+
+float ValueNetwork::forward(const std::uint16_t* active, std::size_t count)
+{
+    std::copy(hiddenBias.begin(), hiddenBias.end(), hidden.begin());
+
+    for (std::size_t i = 0; i < count; i++)
+        addColumn(hidden.data(), inputWeights.data() + active[i] * hiddenSize, hiddenSize);
+
+    const auto logit = reluDot(hidden.data(), outputWeights.data(), hiddenSize) + outputBias;
+
+    return 1.0F / (1.0F + std::exp(-logit));
+}
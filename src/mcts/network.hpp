@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "evaluator.hpp"
+
+// A single hidden layer value network over the stones on the board, relative
+// to the side to move. As the input is sparse the hidden layer is built by
+// summing one weight column per stone, so the cost scales with the number
+// of stones rather than the board area.
+//
+// Weight file layout, all little-endian:
+//     char[4]   magic "GOTN"
+//     uint32    version (1)
+//     uint32    board size S
+//     uint32    hidden size H, a multiple of 8
+//     float     input weights [2 * S * S][H], own stones then enemy stones
+//     float     hidden bias [H]
+//     float     output weights [H]
+//     float     output bias
+class ValueNetwork : public Evaluator
+{
+    public:
+        explicit ValueNetwork(const std::string& path);
+
+        [[nodiscard]] bool supports(std::uint16_t size) const override { return size == boardSize; }
+
+        void gather(const Board& board) override;
+
+        void evaluate(std::vector<float>& values) override;
+
+    private:
+        float forward(const std::uint16_t* features, std::size_t count);
+
+        std::uint16_t boardSize{};
+        std::uint32_t hiddenSize{};
+        std::vector<float> inputWeights{};
+        std::vector<float> hiddenBias{};
+        std::vector<float> outputWeights{};
+        float outputBias{};
+
+        // active features of every gathered position, back to back
+        std::vector<std::uint16_t> features{};
+        std::vector<std::uint32_t> offsets{};
+        std::vector<float> hidden{};
+};
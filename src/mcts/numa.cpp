@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "numa.hpp"
+
+namespace {
+    std::atomic<bool> pinning{false};
+    std::atomic<std::size_t> nextSlot{0};
+
+    // cpus listed as "0-3,8,10-11"
+    std::vector<int> parseCpuList(const std::string& list)
+    {
+        std::vector<int> cpus{};
+        std::istringstream ranges(list);
+
+        for (std::string range{}; std::getline(ranges, range, ',');)
+        {
+            if (range.empty() || range[0] == '\n')
+                continue;
+
+            const auto dash = range.find('-');
+            const auto first = std::stoi(range.substr(0, dash));
+            const auto last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+
+            for (auto cpu = first; cpu <= last; cpu++)
+                cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
+
+    // cpus this process may run on, as set by taskset or a cgroup cpuset
+    std::vector<int> allowedCpus()
+    {
+        std::vector<int> cpus{};
+
+#if defined(__linux__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+            for (auto cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                if (CPU_ISSET(cpu, &mask))
+                    cpus.push_back(cpu);
+#endif
+
+        if (cpus.empty())
+        {
+            const auto count = std::max(1U, std::thread::hardware_concurrency());
+            for (auto cpu = 0; cpu < static_cast<int>(count); cpu++)
+                cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
+
+    std::vector<CpuPlacement> readLayout()
+    {
+        const auto allowed = allowedCpus();
+        const auto isAllowed = [&](int cpu) { return std::find(allowed.begin(), allowed.end(), cpu) != allowed.end(); };
+
+        // node numbers alongside their allowed cpus, nodes may be numbered with gaps
+        std::vector<std::pair<int, std::vector<int>>> nodes{};
+
+#if defined(__linux__)
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string onlineList{};
+        if (online && std::getline(online, onlineList))
+        {
+            for (const auto node : parseCpuList(onlineList))
+            {
+                std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                std::string list{};
+                if (!file || !std::getline(file, list))
+                    continue;
+
+                std::vector<int> cpus{};
+                for (const auto cpu : parseCpuList(list))
+                    if (isAllowed(cpu))
+                        cpus.push_back(cpu);
+
+                if (!cpus.empty())
+                    nodes.emplace_back(node, std::move(cpus));
+            }
+        }
+#endif
+
+        if (nodes.empty())
+            nodes.emplace_back(0, allowed);
+
+        std::vector<CpuPlacement> layout{};
+        for (std::size_t i = 0;; i++)
+        {
+            auto added = false;
+            for (const auto& [node, cpus] : nodes)
+            {
+                if (i < cpus.size())
+                {
+                    layout.push_back(CpuPlacement{cpus[i], node});
+                    added = true;
+                }
+            }
+
+            if (!added)
+                break;
+        }
+
+        return layout;
+    }
+}
+
+const std::vector<CpuPlacement>& cpuLayout()
+{
+    static const auto layout = readLayout();
+    return layout;
+}
+
+CpuPlacement pinThread()
+{
+    const auto& layout = cpuLayout();
+    const auto slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+    auto placement = layout[slot % layout.size()];
+
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(placement.cpu, &cpus);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+        placement.cpu = -1;
+#else
+    placement.cpu = -1;
+#endif
+
+    return placement;
+}
+
+void setPinning(bool enabled)
+{
+    pinning = enabled;
+}
+
+bool pinningEnabled()
+{
+    return pinning;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct CpuPlacement
+{
+    int cpu = -1;
+    int node = 0;
+};
+
+// Every core the process affinity mask allows, ordered so that
+// consecutive entries take turns between NUMA nodes. Falls back to a
+// single node when the topology cannot be read.
+const std::vector<CpuPlacement>& cpuLayout();
+
+// Pins the calling thread to the next entry of `cpuLayout()` and returns
+// it. Entries are handed out in turn to every thread in the process that
+// asks, wrapping around, and threads it starts later inherit the same
+// core. The cpu is -1 where pinning is not supported. Memory the thread
+// touches first after this comes from its own node.
+CpuPlacement pinThread();
+
+// whether pool workers and the GTP search thread pin themselves
+void setPinning(bool enabled);
+
+bool pinningEnabled();
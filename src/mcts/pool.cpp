@@ -0,0 +1,98 @@
+#include <iostream>
+
+#include "numa.hpp"
+#include "pool.hpp"
+
+ThreadPool::ThreadPool(std::size_t threads)
+{
+    for (std::size_t i = 0; i < threads; i++)
+        workers.emplace_back([this, i] { work(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.push_back(std::move(task));
+    }
+
+    wake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    idle.wait(guard, [this] { return tasks.empty() && running == 0; });
+}
+
+void ThreadPool::runAll(std::size_t count, const std::function<void(std::size_t)>& task)
+{
+    std::mutex doneLock{};
+    std::condition_variable done{};
+    auto remaining = count;
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        submit([&, i] {
+            task(i);
+
+            // notified under the lock, as the caller may return right after
+            std::lock_guard<std::mutex> guard(doneLock);
+            remaining--;
+            done.notify_one();
+        });
+    }
+
+    std::unique_lock<std::mutex> guard(doneLock);
+    done.wait(guard, [&] { return remaining == 0; });
+}
+
+void ThreadPool::work(std::size_t index)
+{
+    if (pinningEnabled())
+    {
+        const auto placement = pinThread();
+
+        std::lock_guard<std::mutex> guard(lock);
+        std::cerr << "# worker " << index << " cpu " << placement.cpu << " node " << placement.node << std::endl;
+    }
+
+    while (true)
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || !tasks.empty(); });
+
+            if (tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            running++;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            running--;
+        }
+
+        idle.notify_all();
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running queued tasks in order of submission.
+// With pinning enabled each worker is bound to its own core on start.
+class ThreadPool
+{
+    public:
+        explicit ThreadPool(std::size_t threads);
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(std::function<void()> task);
+
+        // blocks until every submitted task has finished
+        void wait();
+
+        // Runs `task(i)` for every i below `count` on the workers, and blocks
+        // until those have finished. Unlike `wait` it does not wait on tasks
+        // from anyone else, so many callers can share the pool.
+        void runAll(std::size_t count, const std::function<void(std::size_t)>& task);
+
+        [[nodiscard]] std::size_t size() const { return workers.size(); }
+
+    private:
+        void work(std::size_t index);
+
+        std::vector<std::thread> workers{};
+        std::deque<std::function<void()>> tasks{};
+        std::mutex lock{};
+        std::condition_variable wake{};
+        std::condition_variable idle{};
+        std::size_t running = 0;
+        bool stopping = false;
+};
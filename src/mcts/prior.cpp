@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "prior.hpp"
+
+namespace {
+    constexpr std::int16_t PassPrior = -100;
+    constexpr std::int16_t NearLastMove = 30;
+    constexpr std::int16_t NearOwnMove = 10;
+    constexpr std::int16_t Contact = 10;
+    constexpr std::int16_t OwnEye = -60;
+    constexpr std::int16_t FirstLine = -30;
+    constexpr std::int16_t SecondLine = -10;
+    constexpr std::int16_t ThirdOrFourthLine = 10;
+    constexpr std::int16_t Capture = 60;
+    constexpr std::int16_t SaveAtari = 50;
+    constexpr std::int16_t Atari = 20;
+    constexpr std::int16_t SelfAtari = -40;
+    constexpr std::int16_t LadderAtari = 30;
+    constexpr std::int16_t LadderEscape = -60;
+
+    auto distance(Tile a, Tile b, std::uint16_t size)
+    {
+        const auto dx = std::abs(a.index() % size - b.index() % size);
+        const auto dy = std::abs(a.index() / size - b.index() / size);
+        return std::max(dx, dy);
+    }
+}
+
+std::int16_t priorBefore(const Board& board, Tile move)
+{
+    if (move.isNull())
+        return PassPrior;
+
+    const auto size = board.size();
+    const auto stm = board.sideToMove();
+    std::int16_t prior = 0;
+
+    const auto lastMove = board.lastMove(0);
+    if (!lastMove.isNull() && distance(move, lastMove, size) <= 2)
+        prior += NearLastMove;
+
+    const auto ownMove = board.lastMove(1);
+    if (!ownMove.isNull() && distance(move, ownMove, size) <= 2)
+        prior += NearOwnMove;
+
+    // 3x3 neighbourhood: contact with any stone, filling in our own eye,
+    // and extending a group of ours that is in atari
+    auto friendlyAdj = 0;
+    auto savesAtari = false;
+    const auto dirs = Vec4::getAdjacent(move, size);
+    for (auto i = 0; i < dirs.length; i++)
+    {
+        const auto adjTile = dirs.elements[i];
+        const auto owner = board.board.belongsTo(adjTile);
+        friendlyAdj += owner == stm;
+        savesAtari |= owner == stm && board.board.liberties(adjTile) == 1;
+    }
+
+    auto stonesNear = friendlyAdj;
+    const auto diags = Vec4::getDiagonal(move, size);
+    for (auto i = 0; i < diags.length; i++)
+        stonesNear += board.board.belongsTo(diags.elements[i]) != Colour::None;
+
+    if (friendlyAdj == dirs.length)
+        prior += OwnEye;
+    else if (stonesNear > 0)
+        prior += Contact;
+
+    if (savesAtari)
+        prior += SaveAtari;
+
+    // lines from the edge
+    const auto x = move.index() % size;
+    const auto y = move.index() / size;
+    const auto line = std::min({x, y, size - 1 - x, size - 1 - y});
+
+    if (line == 0)
+        prior += FirstLine;
+    else if (line == 1)
+        prior += SecondLine;
+    else if (size >= 9 && line <= 3)
+        prior += ThirdOrFourthLine;
+
+    return prior;
+}
+
+std::int16_t priorAfter(const Board& board, Tile move, std::array<std::uint16_t, 2> stonesBefore,
+                        LadderReader* ladders)
+{
+    if (move.isNull())
+        return 0;
+
+    // `board` has already played `move`, so the mover is the side not to move
+    const auto opp = static_cast<std::uint8_t>(board.sideToMove());
+    std::int16_t prior = 0;
+
+    const auto captured = board.stones()[opp] < stonesBefore[opp];
+    if (captured)
+        prior += Capture;
+
+    const auto dirs = Vec4::getAdjacent(move, board.size());
+    for (auto i = 0; i < dirs.length; i++)
+    {
+        const auto adjTile = dirs.elements[i];
+        if (board.board.belongsTo(adjTile) == board.sideToMove() && board.board.liberties(adjTile) == 1)
+        {
+            prior += Atari;
+            if (ladders && ladders->captured(board.board, adjTile))
+                prior += LadderAtari;
+            break;
+        }
+    }
+
+    const auto liberties = board.board.liberties(move);
+    if (!captured && liberties == 1)
+        prior += SelfAtari;
+
+    // running from atari only to be chased down the ladder
+    if (ladders && !captured && liberties == 2 && board.board.stonesOf(move).len() > 1
+        && ladders->canCapture(board.board, move))
+        prior += LadderEscape;
+
+    return prior;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "../state/board.hpp"
+#include "ladder.hpp"
+
+// Cheap static move ordering used to decide which children are unlocked
+// first by progressive widening. Split into the features read before the
+// move is made and those read after it, so that `Node` can compute both
+// inside its existing legality loop without extra make/undo pairs.
+std::int16_t priorBefore(const Board& board, Tile move);
+
+// With `ladders` given, ataris that start a working ladder and escapes
+// that run into one are scored too.
+std::int16_t priorAfter(const Board& board, Tile move, std::array<std::uint16_t, 2> stonesBefore,
+                        LadderReader* ladders = nullptr);
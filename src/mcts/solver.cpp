@@ -0,0 +1,128 @@
+#include <algorithm>
+
+#include "prior.hpp"
+#include "solver.hpp"
+
+namespace {
+    // results are scored for the side to move, with unresolved lines as 0
+    constexpr std::int8_t WinValue = 1;
+    constexpr std::int8_t LossValue = -1;
+}
+
+Solver::Solver(std::uint8_t tableBits)
+{
+    table = std::vector<Entry>(std::size_t{1} << tableBits);
+    mask = (std::uint64_t{1} << tableBits) - 1;
+}
+
+SolveResult Solver::solve(Board& board, std::uint16_t maxDepth)
+{
+    SolveResult result{};
+    nodes = 0;
+
+    for (rootDepth = 1; rootDepth <= maxDepth; rootDepth++)
+    {
+        rootBest = Tile{};
+        const auto value = negamax(board, rootDepth, LossValue, WinValue);
+
+        result.move = rootBest;
+        result.depth = rootDepth;
+
+        if (value != 0)
+        {
+            result.result = value == WinValue ? State::Win : State::Loss;
+            break;
+        }
+    }
+
+    result.nodes = nodes;
+    return result;
+}
+
+std::int8_t Solver::negamax(Board& board, std::uint16_t depth, std::int8_t alpha, std::int8_t beta)
+{
+    nodes++;
+
+    const auto state = board.gameState();
+    if (state != State::Ongoing)
+        return state == State::Win ? WinValue : LossValue;
+
+    if (depth == 0)
+        return 0;
+
+    const auto key = board.key();
+    auto& entry = table[key.key() & mask];
+    auto ttMove = Tile{};
+    auto ttHit = false;
+
+    const auto isRoot = depth == rootDepth;
+
+    if (entry.bound != Bound::None && entry.hash == key)
+    {
+        ttMove = entry.best;
+        ttHit = true;
+
+        // proven results hold at any depth
+        const auto usable = !isRoot && (entry.depth >= depth || entry.value != 0);
+        if (usable)
+        {
+            if (entry.bound == Bound::Exact
+                || (entry.bound == Bound::Lower && entry.value >= beta)
+                || (entry.bound == Bound::Upper && entry.value <= alpha))
+                return entry.value;
+        }
+    }
+
+    // move ordering: the table move, then by static prior, pass last
+    std::vector<std::pair<std::int16_t, Tile>> moves{};
+    const auto head = board.board.moveHead();
+    for (auto move = head.first; !move.isNull(); move = board.board[move].next)
+    {
+        const auto score = ttHit && move == ttMove ? INT16_MAX : priorBefore(board, move);
+        moves.push_back({score, move});
+    }
+
+    std::stable_sort(moves.begin(), moves.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+
+    if (ttHit && ttMove.isNull())
+        moves.insert(moves.begin(), {INT16_MAX, Tile{}});
+    else
+        moves.push_back({0, Tile{}});
+
+    const auto origAlpha = alpha;
+    auto best = static_cast<std::int8_t>(LossValue - 1);
+    auto bestMove = Tile{};
+
+    for (const auto& [score, move] : moves)
+    {
+        if (!board.tryMakeMove(move))
+            continue;
+
+        const auto value = static_cast<std::int8_t>(-negamax(board, depth - 1, -beta, -alpha));
+
+        board.undoMove();
+
+        if (value > best)
+        {
+            best = value;
+            bestMove = move;
+        }
+
+        alpha = std::max(alpha, value);
+        if (alpha >= beta)
+            break;
+    }
+
+    if (isRoot)
+        rootBest = bestMove;
+
+    entry.hash = key;
+    entry.best = bestMove;
+    entry.value = best;
+    entry.depth = depth;
+    entry.bound = best <= origAlpha ? Bound::Upper : best >= beta ? Bound::Lower : Bound::Exact;
+
+    return best;
+}
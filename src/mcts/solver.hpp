@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../state/board.hpp"
+
+struct SolveResult
+{
+    State result = State::Ongoing;
+    Tile move{};
+    std::uint16_t depth{};
+    std::uint64_t nodes{};
+};
+
+// Exact solver for small boards: iterative deepening alpha-beta over
+// win/unknown/loss, with a transposition table keyed by the Zobrist hash.
+// Note the table ignores how a position was reached, so superko can make
+// a stored result inexact in rare cycles.
+class Solver
+{
+    public:
+        explicit Solver(std::uint8_t tableBits = 20);
+
+        SolveResult solve(Board& board, std::uint16_t maxDepth);
+
+    private:
+        enum struct Bound : std::uint8_t
+        {
+            None = 0,
+            Exact = 1,
+            Lower = 2,
+            Upper = 3,
+        };
+
+        struct Entry
+        {
+            Zobrist hash{};
+            Tile best{};
+            std::int8_t value{};
+            std::uint16_t depth{};
+            Bound bound = Bound::None;
+        };
+
+        std::int8_t negamax(Board& board, std::uint16_t depth, std::int8_t alpha, std::int8_t beta);
+
+        std::vector<Entry> table{};
+        std::uint64_t mask{};
+        std::uint64_t nodes{};
+        Tile rootBest{};
+        std::uint16_t rootDepth{};
+};
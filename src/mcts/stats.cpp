@@ -0,0 +1,67 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include "stats.hpp"
+
+namespace {
+    std::atomic<std::uint64_t> allocCount{0};
+
+    constexpr std::array<const char*, 5> PhaseNames = {"select", "expand", "simulate", "backprop", "evaluate"};
+}
+
+#ifdef GOTCHA_STATS
+void* operator new(std::size_t bytes)
+{
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(bytes ? bytes : 1))
+        return ptr;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
+
+std::uint64_t heapAllocations()
+{
+    return allocCount.load(std::memory_order_relaxed);
+}
+
+std::string SearchStats::report() const
+{
+    std::ostringstream out{};
+
+    const auto nps = time > 0 ? 1000 * nodes / static_cast<std::uint64_t>(time) : nodes;
+
+    out << "time " << time << " rollouts " << rollouts << " nodes " << nodes;
+    out << " nps " << nps << " tree " << treeSize;
+
+    if constexpr (!TrackStats)
+        return out.str();
+
+    std::int64_t totalNs = 0;
+    for (const auto ns : phaseNs)
+        totalNs += ns;
+
+    for (std::size_t i = 0; i < PhaseNames.size(); i++)
+    {
+        const auto calls = phaseCalls[i] ? phaseCalls[i] : 1;
+        const auto share = totalNs ? 100.0 * phaseNs[i] / totalNs : 0.0;
+        out << "\n" << PhaseNames[i] << " " << phaseNs[i] / 1000 << "us";
+        out << " calls " << phaseCalls[i];
+        out << " avg " << phaseNs[i] / static_cast<std::int64_t>(calls) << "ns";
+        out << " share " << share << "%";
+    }
+
+    const auto perRollout = rollouts ? rollouts : 1;
+    out << "\ndepth " << static_cast<double>(depth) / perRollout;
+    out << " allocations " << allocations;
+    out << " allocs/rollout " << static_cast<double>(allocations) / perRollout;
+
+    return out.str();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Build with `make stats` to time the individual search stages,
+// otherwise all of the per-stage bookkeeping compiles away.
+#ifdef GOTCHA_STATS
+constexpr bool TrackStats = true;
+#else
+constexpr bool TrackStats = false;
+#endif
+
+enum struct Phase : std::uint8_t
+{
+    Select = 0,
+    Expand = 1,
+    Simulate = 2,
+    Backprop = 3,
+    Evaluate = 4,
+};
+
+std::uint64_t heapAllocations();
+
+struct SearchStats
+{
+    std::array<std::int64_t, 5> phaseNs{};
+    std::array<std::uint64_t, 5> phaseCalls{};
+    std::uint64_t depth{};
+    std::uint64_t allocations{};
+    std::uint64_t rollouts{};
+    std::uint64_t nodes{};
+    std::int32_t treeSize{};
+    std::int64_t time{};
+
+    void reset() { *this = SearchStats{}; }
+
+    std::string report() const;
+};
+
+class PhaseTimer
+{
+    public:
+        PhaseTimer(SearchStats& searchStats, Phase phase)
+        {
+            if constexpr (TrackStats)
+            {
+                stats = &searchStats;
+                idx = static_cast<std::uint8_t>(phase);
+                clockStart = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~PhaseTimer()
+        {
+            if constexpr (TrackStats)
+            {
+                const auto dur = std::chrono::steady_clock::now() - clockStart;
+                const auto durNs = std::chrono::duration_cast<std::chrono::nanoseconds>(dur);
+                stats->phaseNs[idx] += static_cast<std::int64_t>(durNs.count());
+                stats->phaseCalls[idx] += 1;
+            }
+        }
+
+    private:
+        SearchStats* stats = nullptr;
+        std::uint8_t idx = 0;
+        std::chrono::time_point<std::chrono::steady_clock> clockStart;
+};
@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 
+#include "trace.hpp"
+
 class Timer
 {
     public:
@@ -16,12 +19,29 @@ class Timer
 
         Timer() {}
 
+        // for fixed rollout searches, where only the rollout budget should end a search
+        static Timer unlimited() { return Timer(0, 1000000, 1); }
+
+        // allocates `ms` milliseconds to every move
+        static Timer perMove(std::int64_t ms)
+        {
+            auto timer = Timer(0, 0, 1);
+            timer.byoYomi = 3 * ms;
+            timer.reset();
+            return timer;
+        }
+
         std::int64_t alloc() const
         {
-            if (usingMainTime)
-                return ((byoYomi < 100) ? remainingTime : mainTime) / 25;
-            else
-                return remainingTime / (remainingStones + 2);
+            const auto share = usingMainTime
+                ? ((byoYomi < 100 || mainTime == 0) ? remainingTime : mainTime) / 25
+                : remainingTime / (remainingStones + 2);
+
+            // leave room for the time spent outside the search
+            const auto allocated = std::max<std::int64_t>(share - overhead - lag, 1);
+
+            traceInstant("timer alloc", allocated);
+            return allocated;
         }
 
         void start()
@@ -41,8 +61,10 @@ class Timer
         {
             const auto ms = elapsed();
 
+            lastElapsed = ms;
             remainingTime -= ms;
             remainingStones -= !wasPass;
+            traceInstant("timer stop", ms);
 
             if ((usingMainTime && (remainingTime <= 0))
                 || (!usingMainTime && (remainingStones == 0)))
@@ -55,6 +77,32 @@ class Timer
             }
         };
 
+        // Takes over the clock as the server sees it, `stones` being 0 in
+        // main time and otherwise the stones left in the current period.
+        void sync(std::int64_t ms, std::int64_t stones)
+        {
+            usingMainTime = stones == 0;
+            remainingTime = ms;
+            remainingStones = stones > 0 ? stones : byoYomiStones;
+        }
+
+        // margin kept back from every allocation, for lag we cannot measure
+        void setOverhead(std::int64_t ms) { overhead = ms; }
+
+        // Charges the time spent on a move outside of the search, from
+        // receiving the command to sending the reply, and keeps a running
+        // average of it to leave out of later allocations.
+        void addLag(std::int64_t ms)
+        {
+            lag = (3 * lag + ms) / 4;
+
+            // a fresh byo-yomi period has not been charged for this move
+            if (usingMainTime || remainingStones < byoYomiStones)
+                remainingTime -= ms;
+        }
+
+        [[nodiscard]] auto lastMoveTime() const { return lastElapsed; }
+
         void reset()
         {
             usingMainTime = mainTime > 0;
@@ -70,4 +118,7 @@ class Timer
         std::int64_t mainTime{};
         std::int64_t byoYomi{};
         std::int64_t byoYomiStones{};
+        std::int64_t overhead{};
+        std::int64_t lag{};
+        std::int64_t lastElapsed{};
 };
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "trace.hpp"
+
+namespace {
+    constexpr std::size_t RingSize = std::size_t{1} << 16;
+
+    struct TraceRecord
+    {
+        const char* name;
+        std::int64_t ns;
+        std::int64_t value;
+        char phase;
+    };
+
+    // Written only by the thread that owns it, read when saving. Rings
+    // outlive their threads and are handed on to later ones.
+    struct TraceRing
+    {
+        std::vector<TraceRecord> records = std::vector<TraceRecord>(RingSize);
+        std::atomic<std::uint64_t> head{0};
+        std::size_t tid = 0;
+        bool inUse = true;
+    };
+
+    std::mutex registryLock{};
+    std::vector<std::unique_ptr<TraceRing>> rings{};
+
+    const auto traceStart = std::chrono::steady_clock::now();
+
+    struct RingHandle
+    {
+        TraceRing* ring = nullptr;
+
+        ~RingHandle()
+        {
+            if (ring == nullptr)
+                return;
+
+            std::lock_guard<std::mutex> guard(registryLock);
+            ring->inUse = false;
+        }
+    };
+
+    TraceRing& localRing()
+    {
+        thread_local RingHandle handle{};
+
+        if (handle.ring == nullptr)
+        {
+            std::lock_guard<std::mutex> guard(registryLock);
+
+            for (auto& ring : rings)
+            {
+                if (!ring->inUse)
+                {
+                    ring->inUse = true;
+                    handle.ring = ring.get();
+                    break;
+                }
+            }
+
+            if (handle.ring == nullptr)
+            {
+                rings.push_back(std::make_unique<TraceRing>());
+                rings.back()->tid = rings.size();
+                handle.ring = rings.back().get();
+            }
+        }
+
+        return *handle.ring;
+    }
+}
+
+void traceEvent(const char* name, char phase, std::int64_t value)
+{
+    const auto dur = std::chrono::steady_clock::now() - traceStart;
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count();
+
+    auto& ring = localRing();
+    const auto head = ring.head.load(std::memory_order_relaxed);
+    ring.records[head % RingSize] = TraceRecord{name, ns, value, phase};
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+const char* traceName(const std::string& name)
+{
+    static std::mutex lock{};
+    // never shrinks, and node based so the strings never move
+    static std::unordered_set<std::string> names{};
+
+    std::lock_guard<std::mutex> guard(lock);
+    return names.insert(name).first->c_str();
+}
+
+std::size_t saveTrace(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+
+    std::size_t written = 0;
+    out << "{\"traceEvents\":[";
+
+    std::lock_guard<std::mutex> guard(registryLock);
+
+    for (const auto& ring : rings)
+    {
+        // events still being written by a running thread may be torn
+        const auto head = ring->head.load(std::memory_order_acquire);
+        const auto first = head > RingSize ? head - RingSize : 0;
+
+        for (auto i = first; i < head; i++)
+        {
+            const auto& record = ring->records[i % RingSize];
+
+            out << (written++ ? ",\n" : "\n");
+            out << "{\"name\":\"" << record.name << "\",\"ph\":\"" << record.phase << "\"";
+            out << ",\"ts\":" << record.ns / 1000 << "." << (record.ns % 1000) / 100;
+            out << ",\"pid\":1,\"tid\":" << ring->tid;
+            if (record.phase == 'i')
+                out << ",\"s\":\"t\",\"args\":{\"value\":" << record.value << "}";
+            out << "}";
+        }
+    }
+
+    out << "\n]}" << std::endl;
+
+    return written;
+}
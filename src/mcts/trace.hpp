@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Build with `make trace` to record timestamped events into a ring buffer
+// per thread, otherwise all of the trace points compile away.
+#ifdef GOTCHA_TRACE
+constexpr bool TrackTrace = true;
+#else
+constexpr bool TrackTrace = false;
+#endif
+
+// Adds an event to the calling thread's ring buffer, `phase` being 'B' or
+// 'E' to open or close a span and 'i' for an instant. `name` is kept as a
+// pointer, so it must stay valid for the life of the program.
+void traceEvent(const char* name, char phase, std::int64_t value = 0);
+
+// A copy of `name` that lives for the rest of the program, for event
+// names that are not string literals. Copies of equal names are shared.
+const char* traceName(const std::string& name);
+
+// Writes the buffered events of every thread as Chrome trace_event JSON,
+// for chrome://tracing or Perfetto. Returns the number of events written.
+std::size_t saveTrace(const std::string& path);
+
+class TraceScope
+{
+    public:
+        explicit TraceScope(const char* eventName)
+        {
+            if constexpr (TrackTrace)
+            {
+                name = eventName;
+                traceEvent(name, 'B');
+            }
+        }
+
+        ~TraceScope()
+        {
+            if constexpr (TrackTrace)
+                traceEvent(name, 'E');
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* name = nullptr;
+};
+
+inline void traceInstant(const char* name, std::int64_t value)
+{
+    if constexpr (TrackTrace)
+        traceEvent(name, 'i', value);
+}
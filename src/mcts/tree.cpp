@@ -0,0 +1,190 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "../io/mapped.hpp"
+#include "tree.hpp"
+
+namespace {
+    constexpr char TreeMagic[8] = {'G', 'O', 'T', 'T', 'R', 'E', 'E', '1'};
+
+    struct TreeHeader
+    {
+        char magic[8];
+        std::uint64_t rootHigh;
+        std::uint64_t rootLow;
+        float rootKomi;
+        std::uint32_t rootSize;
+        std::uint64_t numNodes;
+        std::uint64_t numEdges;
+    };
+
+    bool isRepresentative(Tile move, std::uint8_t symmetries, std::uint16_t size)
+    {
+        for (std::uint8_t sym = 1; sym < NumSymmetries; sym++)
+            if ((symmetries >> sym) & 1 && symmetric(move, sym, size).index() < move.index())
+                return false;
+
+        return true;
+    }
+}
+
+void SearchTree::clear(Board& board, LadderReader* ladders)
+{
+    nodes.clear();
+    edges.clear();
+    rootKey = board.key();
+    rootSize = board.size();
+    rootKomi = board.getKomi();
+    add(board, ladders);
+}
+
+std::int32_t SearchTree::add(Board& board, LadderReader* ladders)
+{
+    Node node{};
+    node.state = board.gameState();
+    node.firstMove = static_cast<std::uint32_t>(edges.size());
+
+    // Symmetric positions, mostly early on, would otherwise get a
+    // separate child for each image of the same move, so only the
+    // image with the lowest index is kept.
+    const auto symmetries = board.board.symmetries();
+
+    const auto head = board.board.moveHead();
+    for (auto move = head.first;; move = board.board[move].next)
+    {
+        if (symmetries && !isRepresentative(move, symmetries, board.size()))
+            continue;
+
+        const auto prior = priorBefore(board, move);
+        const auto stonesBefore = board.stones();
+
+        const bool isLegal = board.tryMakeMove(move);
+        if (!isLegal)
+            continue;
+
+        edges.push_back(MoveInfo(move, prior + priorAfter(board, move, stonesBefore, ladders)));
+
+        board.undoMove();
+
+        if (move.isNull())
+            break;
+    }
+
+    // children are expanded best prior first
+    std::stable_sort(edges.begin() + node.firstMove, edges.end(), [](const auto& a, const auto& b) {
+        return a.prior > b.prior;
+    });
+
+    node.numMoves = static_cast<std::uint16_t>(edges.size() - node.firstMove);
+    node.leftToExplore = node.numMoves;
+
+    nodes.push_back(node);
+    return size() - 1;
+}
+
+bool SearchTree::playableFrom(Board& board, std::int32_t depth, std::int32_t nodePtr) const
+{
+    const auto& node = nodes[nodePtr];
+    for (std::uint32_t i = 0; i < node.numChildren(); i++)
+    {
+        const auto& move = edge(node, i);
+        if (!move.move.isNull() && board.board.belongsTo(move.move) != Colour::None)
+            return false;
+
+        if (!board.tryMakeMove(move.move))
+            return false;
+
+        const auto playable = depth <= 1 || move.ptr == -1 || playableFrom(board, depth - 1, move.ptr);
+        board.undoMove();
+
+        if (!playable)
+            return false;
+    }
+
+    return true;
+}
+
+void SearchTree::save(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+
+    TreeHeader header{};
+    std::memcpy(header.magic, TreeMagic, 8);
+    header.rootHigh = rootKey.high();
+    header.rootLow = rootKey.key();
+    header.rootKomi = rootKomi;
+    header.rootSize = rootSize;
+    header.numNodes = nodes.size();
+    header.numEdges = edges.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(Node)));
+    out.write(reinterpret_cast<const char*>(edges.data()), static_cast<std::streamsize>(edges.size() * sizeof(MoveInfo)));
+
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+}
+
+void SearchTree::load(const std::string& path)
+{
+    const MappedFile file(path);
+
+    TreeHeader header{};
+    if (file.size() < sizeof(header))
+        throw std::runtime_error("not a tree file");
+
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    const auto expected = sizeof(header) + header.numNodes * sizeof(Node) + header.numEdges * sizeof(MoveInfo);
+    if (std::memcmp(header.magic, TreeMagic, 8) != 0 || header.numNodes == 0 || file.size() != expected)
+        throw std::runtime_error("not a tree file");
+
+    if (header.rootSize < 2 || header.rootSize > 25)
+        throw std::runtime_error("not a tree file");
+
+    // the search keeps growing the tree, so it is copied out of the mapping
+    const auto nodeData = file.data() + sizeof(header);
+    const auto edgeData = nodeData + header.numNodes * sizeof(Node);
+
+    decltype(nodes) loadedNodes(header.numNodes);
+    std::memcpy(loadedNodes.data(), nodeData, header.numNodes * sizeof(Node));
+
+    decltype(edges) loadedEdges(header.numEdges, MoveInfo(Tile{}, 0));
+    std::memcpy(loadedEdges.data(), edgeData, header.numEdges * sizeof(MoveInfo));
+
+    // Nothing read is trusted, as the search plays the moves unchecked.
+    // Children always come after their parent, so there are no cycles,
+    // and the explored moves are the first of each node.
+    const auto points = header.rootSize * header.rootSize;
+    for (std::uint64_t i = 0; i < header.numNodes; i++)
+    {
+        const auto& node = loadedNodes[i];
+        const auto validState = node.state == State::Ongoing || node.state == State::Win || node.state == State::Loss;
+
+        if (!validState || node.leftToExplore > node.numMoves
+            || std::uint64_t{node.firstMove} + node.numMoves > header.numEdges
+            || (node.state == State::Ongoing && node.numMoves == 0))
+            throw std::runtime_error("corrupt tree file");
+
+        for (std::uint32_t j = 0; j < node.numMoves; j++)
+        {
+            const auto& move = loadedEdges[node.firstMove + j];
+            const auto explored = j < node.numExplored();
+            const auto validPtr = explored ? move.ptr > static_cast<std::int64_t>(i) && static_cast<std::uint64_t>(move.ptr) < header.numNodes
+                                           : move.ptr == -1;
+
+            if (!validPtr || (!move.move.isNull() && move.move.index() >= points))
+                throw std::runtime_error("corrupt tree file");
+        }
+    }
+
+    nodes.swap(loadedNodes);
+    edges.swap(loadedEdges);
+
+    rootKey = Zobrist(header.rootHigh, header.rootLow);
+    rootKomi = header.rootKomi;
+    rootSize = static_cast<std::uint16_t>(header.rootSize);
+}
@@ -1,89 +1,106 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
-#include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include "../io/parse.hpp"
 #include "../state/board.hpp"
+#include "arena.hpp"
+#include "prior.hpp"
+
+// Progressive widening: a node starts with `WidenBase` children unlocked and
+// gains another each time its visits grow by a factor of 1.4.
+constexpr std::uint32_t WidenBase = 2;
+constexpr double WidenScale = 2.97;
 
 struct MoveInfo
 {
-    MoveInfo(Tile tile)
+    MoveInfo(Tile tile, std::int16_t movePrior)
     {
         move = tile;
+        prior = movePrior;
         ptr = -1;
     }
 
     Tile move;
+    std::int16_t prior;
     std::int32_t ptr;
 };
 
-class Node
+// The moves of a node are the `numMoves` edges from `firstMove` in the
+// edge array of its `SearchTree`.
+struct Node
 {
-    public:
-        Node(Board& board)
-        {
-            state = board.gameState();
-
-            const auto head = board.board.moveHead();
-            for (auto move = head.first;; move = board.board[move].next)
-            {
-                const bool isLegal = board.tryMakeMove(move);
-                if (!isLegal)
-                    continue;
-
-                legalMoves.push_back(MoveInfo(move));
+    // terminal nodes, and nodes whose result is proven by their children
+    [[nodiscard]] auto isProven() const { return state != State::Ongoing; }
+    [[nodiscard]] std::uint32_t numChildren() const { return numMoves; }
+    [[nodiscard]] std::uint32_t numExplored() const { return numMoves - leftToExplore; }
 
-                board.undoMove();
+    [[nodiscard]] std::uint32_t numUnlocked() const
+    {
+        const auto extra = visits > 1 ? static_cast<std::uint32_t>(WidenScale * std::log(visits)) : 0;
+        return std::min(numChildren(), WidenBase + extra);
+    }
 
-                if (move.isNull())
-                    break;
-            }
+    State state{};
+    std::uint16_t leftToExplore{};
+    std::uint16_t numMoves{};
+    std::uint32_t firstMove{};
+    std::uint32_t visits{};
+    float wins{};
+};
 
-            leftToExplore = legalMoves.size();
-        }
+static_assert(std::is_trivially_copyable_v<Node>);
+static_assert(std::is_trivially_copyable_v<MoveInfo>);
 
-        [[nodiscard]] auto isTerminal() const { return state != State::Ongoing; }
-        [[nodiscard]] auto numChildren() const { return legalMoves.size(); }
+// Nodes and their edges are each kept in one flat array, so that the
+// whole tree can be written out and read back in as-is. Once large they
+// get pages of their own, local to the thread that grows them.
+class SearchTree
+{
+    public:
+        SearchTree(Board& board) { clear(board); }
 
-        [[nodiscard]] auto& operator[](std::int32_t i) { return legalMoves.at(i); }
-        [[nodiscard]] const auto& operator[](std::int32_t i) const { return legalMoves.at(i); }
+        SearchTree() {}
 
-        State state{};
-        std::uint16_t leftToExplore{};
-        std::uint32_t visits{};
-        std::uint32_t wins{};
+        void clear(Board& board, LadderReader* ladders = nullptr);
 
-    private:
-        std::vector<MoveInfo> legalMoves{};
-};
+        // Creates a node for the position `board` is in.
+        std::int32_t add(Board& board, LadderReader* ladders = nullptr);
 
-struct SearchTree
-{
-    SearchTree(Board& board)
-    {
-        playouts = 0;
-        nodes.push_back(Node(board));
-    }
+        std::int32_t size() const { return static_cast<std::int32_t>(nodes.size()); }
 
-    SearchTree() {}
+        // whether the tree was built from the position `board` is in
+        [[nodiscard]] bool rootedAt(const Board& board) const
+        {
+            return !nodes.empty() && rootKey == board.key()
+                && rootSize == board.size() && rootKomi == board.getKomi();
+        }
 
-    void clear(Board& board)
-    {
-        nodes.clear();
-        nodes.push_back(Node(board));
-        playouts = 0;
-    }
+        // Whether every move of the nodes within `depth` plies of the root
+        // can still be played from `board`, which must be at the root. Ko
+        // and superko depend on the moves before the root as well, which
+        // the root key does not cover.
+        bool playableFrom(Board& board, std::int32_t depth, std::int32_t nodePtr = 0) const;
 
-    std::int32_t size() const { return static_cast<std::int32_t>(nodes.size()); }
+        void save(const std::string& path) const;
 
-    void add(Node n) { nodes.push_back(n); }
+        void load(const std::string& path);
 
-    [[nodiscard]] auto& operator[](std::int32_t i) { return nodes.at(i); }
+        [[nodiscard]] auto& operator[](std::int32_t i) { return nodes.at(i); }
+        [[nodiscard]] const auto& operator[](std::int32_t i) const { return nodes.at(i); }
 
-    std::uint64_t playouts{};
+        [[nodiscard]] auto& edge(const Node& node, std::uint32_t i) { return edges[node.firstMove + i]; }
+        [[nodiscard]] const auto& edge(const Node& node, std::uint32_t i) const { return edges[node.firstMove + i]; }
 
     private:
-        std::vector<Node> nodes{};
+        std::vector<Node, PageAllocator<Node>> nodes{};
+        std::vector<MoveInfo, PageAllocator<MoveInfo>> edges{};
+        Zobrist rootKey{};
+        std::uint16_t rootSize{};
+        float rootKomi{};
 };
@@ -100,6 +100,9 @@ void BoardState::killGroup(const std::uint16_t groupId)
         {
             const auto adjTile = dirs.elements[i];
             const auto adjId = tiles[adjTile.index()].group;
+            if (adjId == 1024)
+                continue;
+
             groups[adjId].liberties++;
             adj.push(adjId);
         }
@@ -110,19 +113,19 @@ void BoardState::killGroup(const std::uint16_t groupId)
     empty.join(dying.stones, tiles);
 }
 
-State BoardState::gameState(float komi) const
+State BoardState::gameState(float komi, std::vector<std::int32_t>* ownership) const
 {
     if (!isGameOver())
         return State::Ongoing;
 
-    const auto netScore = getScore(komi);
+    const auto netScore = getScore(komi, ownership);
 
     const auto winBlack = netScore > 0 ? State::Win : State::Loss;
 
     return winBlack;
 }
 
-float BoardState::getScore(float komi) const
+float BoardState::getScore(float komi, std::vector<std::int32_t>* ownership) const
 {
     auto scoreBlack = stones[0];
     auto scoreWhite = stones[1];
@@ -140,6 +143,20 @@ float BoardState::getScore(float komi) const
             scoreWhite += 1;
     }
 
+    if (ownership != nullptr)
+    {
+        auto& owned = *ownership;
+        for (std::size_t i = 0; i < tiles.size(); i++)
+        {
+            // stones are owned by their colour, empty points by whoever reaches them
+            const auto id = tiles[i].group;
+            const auto black = id != 1024 ? groups[id].belongsTo == Colour::Black : territory[i] == Territory::Black;
+            const auto white = id != 1024 ? groups[id].belongsTo == Colour::White : territory[i] == Territory::White;
+
+            owned[i] += static_cast<std::int32_t>(black) - static_cast<std::int32_t>(white);
+        }
+    }
+
     return static_cast<float>(scoreBlack) - static_cast<float>(scoreWhite) - komi;
 }
 
@@ -207,10 +224,53 @@ std::vector<Territory> BoardState::getTerritory() const
     return territory;
 }
 
+std::array<Zobrist, NumSymmetries> BoardState::symmetricHashes() const
+{
+    std::array<Zobrist, NumSymmetries> hashes{};
+
+    for (std::uint16_t i = 0; i < sizeOf(); i++)
+    {
+        const auto groupId = tiles[i].group;
+        if (groupId == 1024)
+            continue;
+
+        const auto colour = groups[groupId].belongsTo;
+        for (std::uint8_t sym = 0; sym < NumSymmetries; sym++)
+            hashes[sym] ^= Zobrist::hashFor(symmetric(Tile(i), sym, size), colour);
+    }
+
+    return hashes;
+}
+
+std::pair<Zobrist, std::uint8_t> BoardState::canonicalHash() const
+{
+    const auto hashes = symmetricHashes();
+
+    std::uint8_t best = 0;
+    for (std::uint8_t sym = 1; sym < NumSymmetries; sym++)
+        if (hashes[sym] < hashes[best])
+            best = sym;
+
+    return {hashes[best], best};
+}
+
+std::uint8_t BoardState::symmetries() const
+{
+    const auto hashes = symmetricHashes();
+
+    std::uint8_t mask = 0;
+    for (std::uint8_t sym = 1; sym < NumSymmetries; sym++)
+        if (hashes[sym] == hashes[0])
+            mask |= 1 << sym;
+
+    return mask;
+}
+
 void Board::makeMove(const Tile tile)
 {
     nodes++;
     history.push_back(board);
+    moves.push_back(tile);
     const auto moving = stm;
     stm = flipColour(stm);
 
@@ -220,9 +280,21 @@ void Board::makeMove(const Tile tile)
         board.placeStone(tile, moving);
 }
 
+void Board::replayMove(const Tile tile, Colour colour)
+{
+    moves.push_back(tile);
+    stm = flipColour(colour);
+
+    if (tile.isNull())
+        board.passMove();
+    else
+        board.placeStone(tile, colour);
+}
+
 bool Board::tryMakeMove(const Tile tile)
 {
     history.push_back(board);
+    moves.push_back(tile);
     const auto moving = stm;
     stm = flipColour(stm);
 
@@ -256,12 +328,12 @@ bool Board::tryMakeMove(const Tile tile)
     return true;
 }
 
-void Board::display(const bool showGroups) const
+void Board::display(const bool showGroups, std::ostream& out) const
 {
-    board.display(showGroups, komi);
+    board.display(showGroups, komi, out);
     const auto side = stm == Colour::Black ? "black" : "white";
-    std::cout << "STM: " << side << std::endl;
-    std::cout << "Moves Played: " << history.size() << "\n" << std::endl;
+    out << "STM: " << side << std::endl;
+    out << "Moves Played: " << history.size() << "\n" << std::endl;
 }
 
 std::uint64_t Board::runPerft(uint8_t depth)
@@ -294,11 +366,11 @@ std::uint64_t Board::runPerft(uint8_t depth)
     return count;
 }
 
-void BoardState::display(const bool showGroups, float komi) const
+void BoardState::display(const bool showGroups, float komi, std::ostream& out) const
 {
-    std::cout << "=\nBoard:" << std::endl;
-    std::cout << "Score: " << getScore(komi) << " (komi = " << komi << ")" << std::endl;
-    hash.display();
+    out << "=\nBoard:" << std::endl;
+    out << "Score: " << getScore(komi) << " (komi = " << komi << ")" << std::endl;
+    hash.display(out);
 
     for (auto i = 0; i < size; i++)
     {
@@ -307,20 +379,20 @@ void BoardState::display(const bool showGroups, float komi) const
         {
             const auto tileGroup = tiles[size * k + j].group;
             if (showGroups)
-                std::cout << std::setw(4) << tileGroup << " ";
+                out << std::setw(4) << tileGroup << " ";
             else
             {
                 if (tileGroup == 1024)
-                    std::cout << ". ";
+                    out << ". ";
                 else
                 {
                     const auto side = groups[tileGroup].belongsTo;
                     const char stone = side == Colour::Black ? 'o' : 'x';
-                    std::cout << stone << ' ';
+                    out << stone << ' ';
                 }
             }
         }
 
-        std::cout << std::endl;
+        out << std::endl;
     }
 }
@@ -37,24 +37,42 @@ class BoardState
 
         void killGroup(const std::uint16_t groupId);
 
-        void display(const bool showGroups, float komi) const;
+        void display(const bool showGroups, float komi, std::ostream& out = std::cout) const;
 
         void passMove() { passes++; }
 
-        State gameState(float komi) const;
+        // `ownership`, when given, gets +1 for every point black owns at
+        // the end of a finished game and -1 for every point white owns.
+        State gameState(float komi, std::vector<std::int32_t>* ownership = nullptr) const;
 
-        float getScore(float komi) const;
+        float getScore(float komi, std::vector<std::int32_t>* ownership = nullptr) const;
 
         std::vector<Territory> getTerritory() const;
 
+        // Smallest hash over the 8 symmetric images of the position,
+        // along with the symmetry that produces it.
+        std::pair<Zobrist, std::uint8_t> canonicalHash() const;
+
+        // Bitmask of the symmetries, other than the identity, that map the
+        // position onto itself.
+        std::uint8_t symmetries() const;
+
         [[nodiscard]] auto isGameOver() const { return passes >= 2; }
+        [[nodiscard]] auto numPasses() const { return passes; }
         [[nodiscard]] auto sizeOf() const { return size * size; }
         [[nodiscard]] auto getHash() const { return hash; }
         [[nodiscard]] auto moveHead() const { return empty; }
         [[nodiscard]] auto numStones() const { return stones; }
         [[nodiscard]] auto operator[](Tile tile) const { return tiles.at(tile.index()); }
         [[nodiscard]] auto width() const { return size; }
-        [[nodiscard]] auto belongsTo(Tile tile)
+        [[nodiscard]] auto liberties(Tile tile) const
+        {
+            const auto id = tiles.at(tile.index()).group;
+            return id == 1024 ? std::uint16_t{0} : groups[id].liberties;
+        }
+        [[nodiscard]] auto stonesOf(Tile tile) const { return groups[tiles.at(tile.index()).group].stones; }
+        [[nodiscard]] auto groupHash(Tile tile) const { return groups[tiles.at(tile.index()).group].hash; }
+        [[nodiscard]] auto belongsTo(Tile tile) const
         {
             const auto id = tiles.at(tile.index()).group;
             if (id == 1024)
@@ -64,6 +82,8 @@ class BoardState
         }
 
     private:
+        std::array<Zobrist, NumSymmetries> symmetricHashes() const;
+
         LinkHead empty;
         std::uint16_t passes;
         std::uint16_t size;
@@ -95,6 +115,14 @@ class Board
 
         bool tryMakeMove(const Tile tile);
 
+        // Plays a recorded move without copying the position into the
+        // history or checking legality, for fast replay of games. Moves
+        // replayed this way cannot be undone, and are not seen by superko.
+        void replayMove(const Tile tile, Colour colour);
+
+        // adds a setup stone, which is not counted as a move
+        void place(const Tile tile, Colour colour) { board.placeStone(tile, colour); }
+
         void setStm(Colour colour) { stm = colour; }
 
         void setKomi(float val) { komi = val; }
@@ -106,19 +134,41 @@ class Board
             stm = flipColour(stm);
             board = history.back();
             history.pop_back();
+            moves.pop_back();
         }
 
-        void display(const bool showGroups) const;
+        void display(const bool showGroups, std::ostream& out = std::cout) const;
 
         std::uint64_t runPerft(uint8_t depth);
 
         [[nodiscard]] float getKomi() const { return komi; }
         [[nodiscard]] auto stones() const { return board.numStones(); }
         [[nodiscard]] auto sideToMove() const { return stm; }
+        [[nodiscard]] auto plies() const { return moves.size(); }
+
+        // hash of the stones, side to move and whether the last move passed
+        [[nodiscard]] auto key() const
+        {
+            auto hash = board.getHash();
+
+            if (stm == Colour::White)
+                hash ^= Zobrist::whiteToMove();
+
+            if (board.numPasses() > 0)
+                hash ^= Zobrist::afterPass();
+
+            return hash;
+        }
+
+        // `back = 0` is the most recent move, null if there isn't one
+        [[nodiscard]] auto lastMove(std::size_t back) const
+        {
+            return back < moves.size() ? moves[moves.size() - 1 - back] : Tile{};
+        }
 
-        [[nodiscard]] auto gameState() const
+        [[nodiscard]] auto gameState(std::vector<std::int32_t>* ownership = nullptr) const
         {
-            const auto blackWin = board.gameState(komi);
+            const auto blackWin = board.gameState(komi, ownership);
 
             if (stm == Colour::White)
                 return flipState(blackWin);
@@ -130,4 +180,5 @@ class Board
         Colour stm;
         float komi = 0.5;
         std::vector<BoardState> history;
+        std::vector<Tile> moves;
 };
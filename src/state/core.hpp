@@ -71,6 +71,43 @@ class Tile
         std::uint16_t tile = 1024;
 };
 
+// The 8 symmetries of the board: bit 2 transposes, then bits 0 and 1
+// mirror the x and y coordinates respectively.
+constexpr std::uint8_t NumSymmetries = 8;
+
+[[nodiscard]] constexpr auto symmetric(Tile tile, std::uint8_t sym, std::uint16_t size)
+{
+    if (tile.isNull())
+        return tile;
+
+    auto x = static_cast<std::uint16_t>(tile.index() % size);
+    auto y = static_cast<std::uint16_t>(tile.index() / size);
+
+    if (sym & 4)
+    {
+        const auto tmp = x;
+        x = y;
+        y = tmp;
+    }
+
+    if (sym & 1)
+        x = size - 1 - x;
+
+    if (sym & 2)
+        y = size - 1 - y;
+
+    return Tile(x, y, size);
+}
+
+[[nodiscard]] constexpr std::uint8_t inverseSymmetry(std::uint8_t sym)
+{
+    // undoing a transpose swaps which axis each mirror applies to
+    if (sym & 4)
+        return 4 | ((sym & 1) << 1) | ((sym & 2) >> 1);
+
+    return sym;
+}
+
 struct Vec4
 {
     std::array<Tile, 4> elements;
@@ -25,6 +25,11 @@ class Zobrist
             return (upper == other.upper) && (lower == other.lower);
         }
 
+        [[nodiscard]] constexpr auto operator<(Zobrist other) const
+        {
+            return (upper < other.upper) || ((upper == other.upper) && (lower < other.lower));
+        }
+
         constexpr auto operator^=(Zobrist other)
         {
             upper ^= other.upper;
@@ -41,6 +46,10 @@ class Zobrist
             return Zobrist(upper >> shift, lower >> shift);
         }
 
+        // low bits, for indexing hash tables
+        [[nodiscard]] constexpr auto key() const { return lower; }
+        [[nodiscard]] constexpr auto high() const { return upper; }
+
         constexpr auto randomise()
         {
             *this ^= *this << 13;
@@ -52,15 +61,33 @@ class Zobrist
 
         static const std::array<Zobrist, HashSize> Hashes;
 
+        // xored in to tell apart positions with white to move
+        static constexpr auto whiteToMove()
+        {
+            return Zobrist(UINT64_C(0x9E3779B97F4A7C15), UINT64_C(0xC2B2AE3D27D4EB4F));
+        }
+
+        // xored in to tell apart positions on different board sizes
+        static constexpr auto forSize(std::uint16_t size)
+        {
+            return Zobrist(UINT64_C(0x8CB92BA72F3D8DD7), size).randomise();
+        }
+
+        // xored in when the last move was a pass
+        static constexpr auto afterPass()
+        {
+            return Zobrist(UINT64_C(0x165667B19E3779F9), UINT64_C(0xD6E8FEB86659FD93));
+        }
+
         static auto hashFor(Tile tile, Colour colour)
         {
             const auto half = MaxBoardSize * static_cast<std::uint16_t>(colour);
             return Hashes[half + tile.index()];
         }
 
-        void display() const
+        void display(std::ostream& out = std::cout) const
         {
-            std::cout << "Hash: " << upper << lower << std::endl;
+            out << "Hash: " << upper << lower << std::endl;
         }
 
     private: